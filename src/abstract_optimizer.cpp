@@ -1,11 +1,25 @@
 #include "abstract_optimizer.h"
+#include "constraint_set.h"
 #include <csapex/param/parameter_factory.h>
 #include <csapex/param/output_progress_parameter.h>
 
+#include <algorithm>
+
 using namespace csapex;
 
+namespace {
+void setProgress(param::OutputProgressParameter* progress, int value, int maximum)
+{
+    // optimizers that run inside a portfolio do not own any parameters
+    if(progress) {
+        progress->setProgress(value, maximum);
+    }
+}
+}
+
 AbstractOptimizer::AbstractOptimizer()
-    : individual_(0)
+    : seed_(0), constraints_(nullptr), repair_constraints_(true), progress_fitness_(nullptr), progress_individual_(nullptr), individual_(0), individuals_(60),
+      progress_evaluation_(nullptr), evaluation_(0)
 {
 
 }
@@ -20,9 +34,48 @@ void AbstractOptimizer::getOptions(YAML::Node &options)
     options["individuals"] = individuals_;
 }
 
+void AbstractOptimizer::getStatistics(YAML::Node& /*statistics*/) const
+{
+
+}
+
+void AbstractOptimizer::setSeed(std::uint64_t seed)
+{
+    seed_ = seed;
+}
+
+std::uint64_t AbstractOptimizer::getSeed() const
+{
+    return seed_;
+}
+
+void AbstractOptimizer::setConstraints(const ConstraintSet* constraints, bool repair)
+{
+    constraints_ = constraints;
+    repair_constraints_ = repair;
+}
+
+void AbstractOptimizer::applyFeasible(const ParameterLayout& layout, const double* values)
+{
+    feasible_.assign(values, values + layout.size());
+
+    if(constraints_ && repair_constraints_) {
+        if(!constraints_->repair(layout, feasible_.data())) {
+            throw InfeasibleCandidate("candidate violates the constraints after repair");
+        }
+    } else {
+        layout.repair(feasible_.data());
+        if(constraints_ && !constraints_->isFeasible(layout, feasible_.data())) {
+            throw InfeasibleCandidate("candidate violates the constraints");
+        }
+    }
+
+    layout.apply(feasible_.data());
+}
+
 void AbstractOptimizer::addParameters(Parameterizable &params)
 {
-    params.addTemporaryParameter(param::ParameterFactory::declareRange("individuals/individuals", 60, 60, 60, 1),
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("individuals/individuals", 4, 1000, 60, 1),
                                  individuals_);
 
     param::Parameter::Ptr progress_fitness = csapex::param::ParameterFactory::declareOutputProgress("fitness level");
@@ -33,7 +86,38 @@ void AbstractOptimizer::addParameters(Parameterizable &params)
     progress_individual_ = dynamic_cast<param::OutputProgressParameter*>(progress_population.get());
     params.addTemporaryParameter(progress_population);
 
+    param::Parameter::Ptr progress_evaluation = csapex::param::ParameterFactory::declareOutputProgress("evaluation");
+    progress_evaluation_ = dynamic_cast<param::OutputProgressParameter*>(progress_evaluation.get());
+    params.addTemporaryParameter(progress_evaluation);
+
     progress_fitness_->setProgress(0,0);
+    progress_evaluation_->setProgress(0,0);
+}
+
+int AbstractOptimizer::getGeneration() const
+{
+    return 0;
+}
+
+int AbstractOptimizer::getEvaluationBudget() const
+{
+    // the generational backends stop after a number of generations
+    return -1;
+}
+
+int AbstractOptimizer::getPopulationSize() const
+{
+    return individuals_;
+}
+
+bool AbstractOptimizer::canResizePopulation() const
+{
+    return false;
+}
+
+void AbstractOptimizer::setPopulationSize(int /*individuals*/)
+{
+    // the EvA2 protocol cannot change the population of a running session
 }
 
 void AbstractOptimizer::nextIteration()
@@ -46,21 +130,35 @@ void AbstractOptimizer::terminate()
 
 }
 
+void AbstractOptimizer::injectIndividual(const std::vector<double>& /*values*/, double /*fitness*/)
+{
+    // the EvA2 protocol cannot insert individuals into the server's population
+}
+
 void AbstractOptimizer::reset()
 {
-    progress_fitness_->setProgress(0,100);
+    setProgress(progress_fitness_, 0, 100);
+
+    evaluation_ = 0;
+    int budget = getEvaluationBudget();
+    setProgress(progress_evaluation_, 0, budget > 0 ? budget : 0);
 }
 
 void AbstractOptimizer::finish(double fitness, double best_fitness, double worst_fitness)
 {
     ++individual_;
-    progress_individual_->setProgress(individual_, individuals_);
+    setProgress(progress_individual_, std::min(individual_, individuals_), individuals_);
+
+    // progress counts evaluations, steady-state backends have no generation barrier to count
+    ++evaluation_;
+    int budget = getEvaluationBudget();
+    setProgress(progress_evaluation_, evaluation_, budget > 0 ? budget : 0);
 
     if(worst_fitness == best_fitness) {
-        progress_fitness_->setProgress(0, 100);
+        setProgress(progress_fitness_, 0, 100);
 
     } else {
         double range = worst_fitness - best_fitness;
-        progress_fitness_->setProgress(100 - ((fitness - best_fitness) / range) * 100, 100);
+        setProgress(progress_fitness_, 100 - ((fitness - best_fitness) / range) * 100, 100);
     }
 }
@@ -6,9 +6,14 @@
 #include <yaml-cpp/yaml.h>
 #include <cslibs_jcppsocket/cpp/socket_msgs.h>
 
+#include <cstdint>
+
 namespace csapex
 {
 
+class ConstraintSet;
+class ParameterLayout;
+
 class AbstractOptimizer
 {
 public:
@@ -18,10 +23,38 @@ public:
     virtual std::string getName() const = 0;
 
     virtual void getOptions(YAML::Node& options);
+    virtual void getStatistics(YAML::Node& statistics) const;
+
+    void setSeed(std::uint64_t seed);
+    std::uint64_t getSeed() const;
+
+    /**
+     * @brief setConstraints makes decoding check every candidate against the given constraints
+     * @param constraints is not owned, nullptr disables the check
+     * @param repair moves infeasible candidates into the feasible region instead of rejecting them
+     */
+    void setConstraints(const ConstraintSet* constraints, bool repair);
 
     virtual void addParameters(Parameterizable& params);
 
     virtual bool canContinue() const = 0;
+    virtual int getGeneration() const;
+    virtual int getEvaluationBudget() const;
+
+    /**
+     * @brief getPopulationSize is the number of individuals of the current generation
+     */
+    virtual int getPopulationSize() const;
+
+    /**
+     * @brief canResizePopulation tells whether setPopulationSize has any effect during a run
+     */
+    virtual bool canResizePopulation() const;
+
+    /**
+     * @brief setPopulationSize requests a population size for the following generations
+     */
+    virtual void setPopulationSize(int individuals);
     virtual void nextIteration();
 
     virtual void terminate();
@@ -33,15 +66,32 @@ public:
                                   const std::vector<param::ParameterPtr> &params) = 0;
 
 
+    virtual void injectIndividual(const std::vector<double>& values, double fitness);
+
     virtual void reset();
     virtual void finish(double fitness, double best_fitness, double worst_fitness);
 
 protected:
+    /**
+     * @brief applyFeasible repairs a copy of the values and applies it to the parameters
+     * @throws InfeasibleCandidate if the constraints are not satisfied, before any parameter is changed
+     */
+    void applyFeasible(const ParameterLayout& layout, const double* values);
+
+protected:
+    std::uint64_t seed_;
+    const ConstraintSet* constraints_;
+    bool repair_constraints_;
+    std::vector<double> feasible_;
+
     param::OutputProgressParameter* progress_fitness_;
 
     param::OutputProgressParameter* progress_individual_;
     int individual_;
     int individuals_;
+
+    param::OutputProgressParameter* progress_evaluation_;
+    int evaluation_;
 };
 
 }
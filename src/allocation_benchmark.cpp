@@ -0,0 +1,288 @@
+/// COMPONENT
+#include "constraint_set.h"
+#include "optimization_report.h"
+#include "optimizer_bo.h"
+#include "optimizer_de.h"
+#include "optimizer_ga.h"
+#include "optimizer_portfolio.h"
+#include "optimizer_pso.h"
+#include "optimizer_ssde.h"
+#include "parameter_batch.h"
+#include "parameter_layout.h"
+#include "parameter_sensitivity.h"
+#include "philox.h"
+
+/// PROJECT
+#include <csapex/param/parameter_factory.h>
+#include <cslibs_jcppsocket/cpp/socket_msgs.h>
+
+/// SYSTEM
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+using namespace csapex;
+
+/*
+ * Counts the heap allocations of the per-individual steps of the optimization loop.
+ * Every step is warmed up once, so that buffers that are sized on first use do not count,
+ * and then run for a fixed number of individuals. A step that is free of allocations
+ * reports 0 per individual.
+ *
+ * The native methods are driven through ask and tell like the node drives them. The surrogate
+ * model of BO costs milliseconds per candidate, so BO and the portfolio run fewer individuals.
+ */
+
+namespace {
+std::atomic<std::size_t> allocations(0);
+}
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if(void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace {
+
+const int WARMUP = 16;
+const int MODEL_INDIVIDUALS = 200;
+
+template <typename Step>
+void measure(const std::string& name, int individuals, Step step)
+{
+    for(int i = 0; i < WARMUP; ++i) {
+        step(i);
+    }
+
+    std::size_t before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < individuals; ++i) {
+        step(WARMUP + i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::size_t count = allocations - before;
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    std::cout << std::left << std::setw(32) << name << std::right
+              << std::setw(12) << std::fixed << std::setprecision(3) << (double) count / individuals << " allocs"
+              << std::setw(12) << std::setprecision(1) << ns / individuals << " ns" << std::endl;
+}
+
+double sphere(const std::vector<double>& values)
+{
+    double sum = 0.0;
+    for(double v : values) {
+        sum += (v - 0.3) * (v - 0.3);
+    }
+    return sum;
+}
+
+void measureNative(const std::string& name, NativeOptimizer& optimizer,
+                   const std::vector<param::ParameterPtr>& params, int individuals)
+{
+    Parameterizable parameters;
+    optimizer.addParameters(parameters);
+    optimizer.setEvaluationBudget(WARMUP + individuals);
+    optimizer.setSeed(1);
+    optimizer.reset();
+
+    YAML::Node description;
+    optimizer.encodeParameters(params, description);
+
+    std::vector<double> values;
+    measure(name, individuals, [&](int) {
+        if(!optimizer.ask(values)) {
+            throw std::logic_error(name + " stopped before its budget");
+        }
+        optimizer.tell(values, sphere(values));
+    });
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    int individuals = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int dimension = argc > 2 ? std::atoi(argv[2]) : 16;
+    if(individuals <= 0 || dimension <= 0) {
+        std::cerr << "usage: " << argv[0] << " [individuals] [dimension]" << std::endl;
+        return 1;
+    }
+
+    std::vector<param::ParameterPtr> params;
+    for(int d = 0; d < dimension; ++d) {
+        std::string name = "parameter_" + std::to_string(d);
+        if(d % 4 == 3) {
+            params.push_back(param::ParameterFactory::declareRange(name, 0, 100, 50, 1));
+        } else {
+            params.push_back(param::ParameterFactory::declareRange(name, 0.0, 1.0, 0.5, 0.001));
+        }
+    }
+
+    // one frozen parameter, which only enters the constraints with its value
+    params.push_back(param::ParameterFactory::declareRange("frozen", 0.0, 1.0, 0.25, 0.001));
+    std::vector<param::ParameterPtr> optimized(params.begin(), params.end() - 1);
+
+    ParameterLayout layout;
+    layout.build(optimized);
+
+    ConstraintSet constraints;
+    constraints.parse("parameter_0 + parameter_1 <= 1.2; parameter_0 - parameter_2 >= -0.5; parameter_1 + frozen <= 1");
+    constraints.setParameters(params);
+    constraints.validate();
+
+    Philox rng;
+    std::vector<double> values(layout.size());
+    auto sample = [&](int individual) {
+        rng.seed(1, 0, individual);
+        for(std::size_t i = 0, n = layout.size(); i < n; ++i) {
+            values[i] = layout[i].min + rng.uniform() * (layout[i].max - layout[i].min);
+        }
+    };
+
+    std::cout << individuals << " individuals, " << layout.size() << " slots" << std::endl;
+
+    measure("ParameterLayout::apply", individuals, [&](int i) {
+        sample(i);
+        layout.repair(values.data());
+        layout.apply(values.data());
+    });
+
+    ParameterBatch batch;
+    std::vector<double> staged;
+    measure("ParameterBatch stage and check", individuals, [&](int i) {
+        sample(i);
+        batch.clear();
+        for(std::size_t s = 0, n = layout.size(); s < n; ++s) {
+            if(layout[s].kind == ParameterLayout::Kind::IntRange) {
+                batch.setInt(layout[s].param, values[s]);
+            } else {
+                batch.setDouble(layout[s].param, values[s]);
+            }
+        }
+        layout.read(batch, staged);
+        if(constraints.isFeasible(layout, staged.data())) {
+            batch.commit();
+        }
+    });
+
+    measure("ConstraintSet::isFeasible", individuals, [&](int i) {
+        sample(i);
+        constraints.isFeasible(layout, values.data());
+    });
+
+    measure("ConstraintSet::repair", individuals, [&](int i) {
+        sample(i);
+        constraints.repair(layout, values.data());
+    });
+
+    // the server sends every individual of a session in the same shape
+    OptimizerDE de;
+    de.setConstraints(&constraints, true);
+    YAML::Node de_description;
+    de.encodeParameters(optimized, de_description);
+
+    cslibs_jcppsocket::VectorMsg<double>::Ptr de_msg(new cslibs_jcppsocket::VectorMsg<double>);
+    de_msg->assign(values.data(), values.size());
+    cslibs_jcppsocket::SocketMsg::Ptr de_individual = de_msg;
+    measure("OptimizerDE::decodeParameters", individuals, [&](int i) {
+        sample(i);
+        de_msg->assign(values.data(), values.size());
+        de.decodeParameters(de_individual, optimized);
+    });
+
+    // bit strings cannot be repaired, infeasible ones would throw, so the GA decodes unchecked
+    OptimizerGA ga;
+    YAML::Node ga_description;
+    ga.encodeParameters(optimized, ga_description);
+
+    std::vector<char> bits((ga_description["problem_dimension"].as<std::size_t>() + 7) / 8);
+    cslibs_jcppsocket::VectorMsg<char>::Ptr ga_msg(new cslibs_jcppsocket::VectorMsg<char>);
+    ga_msg->assign(bits.data(), bits.size());
+    cslibs_jcppsocket::SocketMsg::Ptr ga_individual = ga_msg;
+    measure("OptimizerGA::decodeParameters", individuals, [&](int i) {
+        rng.seed(2, 0, i);
+        for(char& byte : bits) {
+            byte = static_cast<char>(rng.uniform() * 256.0);
+        }
+        ga_msg->assign(bits.data(), bits.size());
+        ga.decodeParameters(ga_individual, optimized);
+    });
+
+    int model_individuals = std::min(individuals, MODEL_INDIVIDUALS);
+
+    OptimizerSSDE ssde;
+    measureNative("OptimizerSSDE ask and tell", ssde, optimized, individuals);
+
+    OptimizerPSO pso;
+    measureNative("OptimizerPSO ask and tell", pso, optimized, individuals);
+
+    OptimizerBO bo;
+    measureNative("OptimizerBO ask and tell", bo, optimized, model_individuals);
+
+    OptimizerPortfolio portfolio;
+    measureNative("OptimizerPortfolio ask and tell", portfolio, optimized, model_individuals);
+
+    // what the node records for every finished evaluation, sized to the budget like in start()
+    OptimizationReport report;
+    report.reset("benchmark", 1);
+    report.reserve(WARMUP + individuals);
+
+    ParameterSensitivity sensitivity;
+    sensitivity.setParameters(optimized);
+    sensitivity.reserve(WARMUP + individuals);
+
+    measure("node evaluation bookkeeping", individuals, [&](int i) {
+        sample(i);
+        layout.repair(values.data());
+        layout.apply(values.data());
+
+        report.beginEvaluation();
+        double fitness = sphere(values);
+        sensitivity.addSample(fitness);
+        report.endEvaluation(i / 32, fitness, fitness);
+    });
+
+    // the node sends every fitness through the same message
+    cslibs_jcppsocket::ValueMsg<double>::Ptr fitness_msg(new cslibs_jcppsocket::ValueMsg<double>);
+    measure("fitness message reuse", individuals, [&](int i) {
+        fitness_msg->set(static_cast<double>(i));
+    });
+
+    return 0;
+}
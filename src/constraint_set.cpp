@@ -0,0 +1,285 @@
+#include "constraint_set.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+using namespace csapex;
+
+namespace {
+// alternating projections converge slowly when constraints meet at a sharp angle
+const int MAX_REPAIR_PASSES = 20;
+
+std::string trim(const std::string& s)
+{
+    std::size_t begin = s.find_first_not_of(" \t\r");
+    if(begin == std::string::npos) {
+        return std::string();
+    }
+    std::size_t end = s.find_last_not_of(" \t\r");
+    return s.substr(begin, end - begin + 1);
+}
+
+std::size_t findSlot(const ParameterLayout& layout, const std::string& name)
+{
+    std::size_t slot = 0;
+    while(slot < layout.size() && layout.name(slot) != name) {
+        ++slot;
+    }
+    return slot;
+}
+
+bool parseNumber(const std::string& s, double& value)
+{
+    if(s.empty()) {
+        return false;
+    }
+    char* end;
+    value = std::strtod(s.c_str(), &end);
+    return *end == '\0';
+}
+
+// adds "c * name" and constant terms of one side of a constraint, scaled by sign
+void parseExpression(const std::string& text, double sign, LinearConstraint& out, const std::string& constraint)
+{
+    // terms are separated by " + " and " - ", so that names may contain dashes
+    std::string expr = " " + trim(text);
+    std::size_t pos = 0;
+    while(pos < expr.size()) {
+        double term_sign = sign;
+        std::size_t start = pos;
+        if(expr.compare(pos, 2, " +") == 0 || expr.compare(pos, 2, " -") == 0) {
+            if(expr[pos + 1] == '-') {
+                term_sign = -sign;
+            }
+            start = pos + 2;
+        }
+
+        std::size_t next = std::min(expr.find(" + ", start), expr.find(" - ", start));
+        std::string term = trim(expr.substr(start, next == std::string::npos ? std::string::npos : next - start));
+        pos = next == std::string::npos ? expr.size() : next;
+
+        if(term.empty()) {
+            throw std::runtime_error("empty term in constraint \"" + constraint + "\"");
+        }
+
+        double coefficient = 1.0;
+        std::string name = term;
+        std::size_t star = term.find('*');
+        if(star != std::string::npos) {
+            if(!parseNumber(trim(term.substr(0, star)), coefficient)) {
+                throw std::runtime_error("invalid coefficient in constraint \"" + constraint + "\"");
+            }
+            name = trim(term.substr(star + 1));
+        }
+
+        double constant;
+        if(star == std::string::npos && parseNumber(name, constant)) {
+            // constants move to the bound
+            out.bound -= term_sign * constant;
+        } else {
+            out.terms.emplace_back(name, term_sign * coefficient);
+        }
+    }
+}
+}
+
+InfeasibleCandidate::InfeasibleCandidate(const std::string& what)
+    : std::runtime_error(what)
+{
+
+}
+
+ConstraintSet::ConstraintSet()
+    : resolved_revision_(0)
+{
+
+}
+
+void ConstraintSet::clear()
+{
+    constraints_.clear();
+    resolved_revision_ = 0;
+}
+
+void ConstraintSet::add(const LinearConstraint& constraint)
+{
+    constraints_.push_back(constraint);
+    resolved_revision_ = 0;
+}
+
+void ConstraintSet::parse(const std::string& text)
+{
+    std::string line;
+    for(std::size_t i = 0; i <= text.size(); ++i) {
+        if(i < text.size() && text[i] != ';' && text[i] != '\n') {
+            line += text[i];
+            continue;
+        }
+
+        std::string constraint = trim(line);
+        line.clear();
+        if(constraint.empty()) {
+            continue;
+        }
+
+        std::size_t op = constraint.find("<=");
+        double sign = 1.0;
+        if(op == std::string::npos) {
+            op = constraint.find(">=");
+            sign = -1.0;
+        }
+        if(op == std::string::npos) {
+            throw std::runtime_error("constraint \"" + constraint + "\" needs <= or >=");
+        }
+
+        // lhs <= rhs becomes lhs - rhs <= 0, >= flips all signs
+        LinearConstraint c;
+        c.bound = 0.0;
+        parseExpression(constraint.substr(0, op), sign, c, constraint);
+        parseExpression(constraint.substr(op + 2), -sign, c, constraint);
+
+        if(c.terms.empty()) {
+            throw std::runtime_error("constraint \"" + constraint + "\" has no parameters");
+        }
+        add(c);
+    }
+}
+
+bool ConstraintSet::empty() const
+{
+    return constraints_.empty();
+}
+
+std::size_t ConstraintSet::size() const
+{
+    return constraints_.size();
+}
+
+void ConstraintSet::setParameters(const std::vector<param::ParameterPtr>& params)
+{
+    if(!parameters_.matches(params)) {
+        parameters_.build(params);
+        resolved_revision_ = 0;
+    }
+}
+
+void ConstraintSet::validate() const
+{
+    for(const LinearConstraint& c : constraints_) {
+        for(const auto& term : c.terms) {
+            if(findSlot(parameters_, term.first) == parameters_.size()) {
+                throw std::runtime_error("constraint refers to unknown parameter \"" + term.first + "\"");
+            }
+        }
+    }
+}
+
+void ConstraintSet::resolve(const ParameterLayout& layout) const
+{
+    if(resolved_revision_ != layout.revision()) {
+        resolved_.clear();
+
+        for(const LinearConstraint& c : constraints_) {
+            Resolved r;
+            r.bound = c.bound;
+
+            bool known = true;
+            for(const auto& term : c.terms) {
+                std::size_t slot = findSlot(layout, term.first);
+                if(slot < layout.size()) {
+                    r.slots.emplace_back(slot, term.second);
+                    continue;
+                }
+
+                std::size_t fixed = findSlot(parameters_, term.first);
+                if(fixed < parameters_.size()) {
+                    r.fixed.emplace_back(fixed, term.second);
+                } else {
+                    known = false;
+                }
+            }
+
+            // unknown names are reported by validate, here they only disable their constraint
+            if(known) {
+                resolved_.push_back(r);
+            }
+        }
+
+        resolved_revision_ = layout.revision();
+    }
+
+    // parameters outside of the layout keep their current value, which may have changed since the last call
+    for(Resolved& r : resolved_) {
+        r.limit = r.bound;
+        for(const auto& f : r.fixed) {
+            r.limit -= f.second * parameters_.value(f.first);
+        }
+    }
+}
+
+bool ConstraintSet::isFeasible(const ParameterLayout& layout, const double* values) const
+{
+    if(constraints_.empty()) {
+        return true;
+    }
+
+    resolve(layout);
+    return isFeasible(values);
+}
+
+bool ConstraintSet::isFeasible(const double* values) const
+{
+    for(const Resolved& r : resolved_) {
+        double sum = 0.0;
+        for(const auto& s : r.slots) {
+            sum += s.second * values[s.first];
+        }
+        if(sum > r.limit + 1e-9 * (1.0 + std::abs(r.limit))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ConstraintSet::repair(const ParameterLayout& layout, double* values) const
+{
+    layout.repair(values);
+    if(constraints_.empty()) {
+        return true;
+    }
+
+    resolve(layout);
+
+    for(int pass = 0; pass < MAX_REPAIR_PASSES; ++pass) {
+        bool violated = false;
+        for(const Resolved& r : resolved_) {
+            double sum = 0.0, norm = 0.0;
+            for(const auto& s : r.slots) {
+                sum += s.second * values[s.first];
+                norm += s.second * s.second;
+            }
+
+            double excess = sum - r.limit;
+            if(excess <= 0.0 || norm <= 0.0) {
+                continue;
+            }
+            violated = true;
+
+            // project onto the boundary, a little inside to be robust against rounding
+            double scale = (excess + 1e-9 * (1.0 + std::abs(r.limit))) / norm;
+            for(const auto& s : r.slots) {
+                values[s.first] -= scale * s.second;
+            }
+        }
+
+        // projection may leave the box or swap interval bounds again
+        layout.repair(values);
+
+        if(!violated) {
+            break;
+        }
+    }
+
+    return isFeasible(values);
+}
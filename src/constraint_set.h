@@ -0,0 +1,102 @@
+#ifndef CONSTRAINT_SET_H
+#define CONSTRAINT_SET_H
+
+#include "parameter_layout.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace csapex
+{
+
+/**
+ * @brief The InfeasibleCandidate exception signals a candidate that violates a constraint and cannot be repaired.
+ */
+class InfeasibleCandidate : public std::runtime_error
+{
+public:
+    InfeasibleCandidate(const std::string& what);
+};
+
+/**
+ * @brief The LinearConstraint struct describes sum(coefficient * parameter) <= bound.
+ *
+ * Terms refer to parameters by name, the bounds of interval parameters are referred to
+ * as "<name>.low" and "<name>.high".
+ */
+struct LinearConstraint
+{
+    std::vector<std::pair<std::string, double>> terms;
+    double bound;
+};
+
+/**
+ * @brief The ConstraintSet class checks and repairs candidates against linear constraints.
+ *
+ * Repair projects the candidate onto every violated constraint in turn and clips it to the
+ * parameter bounds again, until it is feasible or a fixed number of passes is used up.
+ * Parameters that are known but not part of the optimized layout, e.g. frozen ones, enter
+ * a constraint with their current value.
+ */
+class ConstraintSet
+{
+    struct Resolved
+    {
+        std::vector<std::pair<std::size_t, double>> slots;
+        std::vector<std::pair<std::size_t, double>> fixed;
+        double bound;
+        double limit;
+    };
+
+public:
+    ConstraintSet();
+
+    void clear();
+    void add(const LinearConstraint& constraint);
+
+    /**
+     * @brief parse reads constraints like "a + 2 * b <= 10", separated by ';' or new lines
+     * @throws std::runtime_error if the text cannot be parsed
+     */
+    void parse(const std::string& text);
+
+    bool empty() const;
+    std::size_t size() const;
+
+    /**
+     * @brief setParameters declares all parameters that constraints may refer to, optimized or not
+     */
+    void setParameters(const std::vector<param::ParameterPtr>& params);
+
+    /**
+     * @brief validate checks that all constraints refer to declared parameters
+     * @throws std::runtime_error for the first unknown name
+     */
+    void validate() const;
+
+    bool isFeasible(const ParameterLayout& layout, const double* values) const;
+
+    /**
+     * @brief repair moves the values into the feasible region
+     * @return false, if the candidate is still infeasible afterwards
+     */
+    bool repair(const ParameterLayout& layout, double* values) const;
+
+private:
+    void resolve(const ParameterLayout& layout) const;
+    bool isFeasible(const double* values) const;
+
+private:
+    std::vector<LinearConstraint> constraints_;
+    ParameterLayout parameters_;
+
+    // slot indices only change with the layout, so they are resolved once per layout revision
+    mutable std::vector<Resolved> resolved_;
+    mutable unsigned long resolved_revision_;
+};
+
+}
+
+#endif // CONSTRAINT_SET_H
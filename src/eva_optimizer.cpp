@@ -9,13 +9,21 @@
 #include <csapex/model/node_modifier.h>
 #include <csapex/param/range_parameter.h>
 #include <csapex/param/interval_parameter.h>
+#include <csapex/param/trigger_parameter.h>
 #include <cslibs_jcppsocket/cpp/socket_msgs.h>
 #include <csapex/msg/end_of_sequence_message.h>
 #include "optimizer_de.h"
 #include "optimizer_ga.h"
+#include "optimizer_pso.h"
+#include "optimizer_bo.h"
+#include "optimizer_ssde.h"
+#include "optimizer_portfolio.h"
 
 /// SYSTEM
 #include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <limits>
+#include <random>
 
 CSAPEX_REGISTER_CLASS(csapex::EvaOptimizer, csapex::Node)
 
@@ -27,8 +35,31 @@ using namespace serialization;
 
 
 EvaOptimizer::EvaOptimizer()
-    : method_(Method::None)
+    : method_(Method::None),
+      native_running_(false),
+      native_generation_(0),
+      seed_(0),
+      finished_(false),
+      failed_(false),
+      freeze_requested_(false),
+      restarting_(false),
+      local_search_phase_(LocalSearchPhase::Generation),
+      deferred_fitness_(0.0),
+      final_fitness_(0.0),
+      population_generation_(0),
+      fitness_msg_(new ValueMsg<double>),
+      continue_msg_(new VectorMsg<char>),
+      terminate_msg_(new VectorMsg<char>),
+      guard_([this](unsigned long arming) { onEvaluationTimeout(arming); }),
+      evaluating_(false),
+      consecutive_rejections_(0),
+      candidate_failed_(false),
+      skip_infeasible_(false),
+      repair_constraints_(true)
 {
+    // the outgoing messages never change their shape, so they are allocated once and reused
+    continue_msg_->assign("continue", 8);
+    terminate_msg_->assign("terminate", 9);
 }
 
 void EvaOptimizer::setupParameters(Parameterizable& parameters)
@@ -38,64 +69,295 @@ void EvaOptimizer::setupParameters(Parameterizable& parameters)
     parameters.addParameter(param::ParameterFactory::declareText("server name", "localhost"));
     parameters.addParameter(param::ParameterFactory::declareText("server port", "2342"));
 
+    // 0 draws a new seed for every run, the seed of a native method is written into the run outputs
+    parameters.addParameter(param::ParameterFactory::declareValue<int>("seed", 0));
+
     std::map<std::string, int> methods {
         {"Differential Evolution", (int) Method::DE},
-        {"Genetic Algorithm", (int) Method::GA}
+        {"Genetic Algorithm", (int) Method::GA},
+        {"Particle Swarm Optimization", (int) Method::PSO},
+        {"Bayesian Optimization", (int) Method::BO},
+        {"Steady-State Differential Evolution", (int) Method::SSDE},
+        {"Portfolio", (int) Method::Portfolio}
     };
     parameters.addParameter(param::ParameterFactory::declareParameterSet("method", methods, (int) Method::DE),
                             [this](param::Parameter* p){
         updateOptimizer();
     });
+
+    std::map<std::string, int> noise_modes {
+        {"off", (int) NoiseHandler::Mode::Off},
+        {"racing", (int) NoiseHandler::Mode::Racing},
+        {"confidence interval", (int) NoiseHandler::Mode::ConfidenceInterval}
+    };
+    parameters.addParameter(param::ParameterFactory::declareParameterSet("noise/mode", noise_modes, (int) NoiseHandler::Mode::Off));
+    parameters.addParameter(param::ParameterFactory::declareRange("noise/max_samples", 1, 50, 5, 1));
+    parameters.addParameter(param::ParameterFactory::declareRange("noise/confidence", 0.5, 4.0, 1.96, 0.01));
+    parameters.addParameter(param::ParameterFactory::declareRange("noise/tolerance", 0.001, 1.0, 0.05, 0.001));
+
+    // the population grows while the individuals are diverse and shrinks once they converge
+    parameters.addParameter(param::ParameterFactory::declareBool("population/adaptive", false));
+    parameters.addParameter(param::ParameterFactory::declareRange("population/min", 4, 1000, 10, 1));
+    parameters.addParameter(param::ParameterFactory::declareRange("population/max", 4, 1000, 100, 1));
+
+    parameters.addParameter(param::ParameterFactory::declareRange("local_search/every_generations", 0, 100, 0, 1));
+    parameters.addParameter(param::ParameterFactory::declareBool("local_search/after_termination", false));
+    parameters.addParameter(param::ParameterFactory::declareRange("local_search/budget", 1, 1000, 20, 1));
+
+    parameters.addParameter(param::ParameterFactory::declareBool("guard/enabled", false));
+    parameters.addParameter(param::ParameterFactory::declareRange("guard/timeout", 0.0, 3600.0, 60.0, 0.1));
+    parameters.addParameter(param::ParameterFactory::declareValue<double>("guard/penalty", 1e6));
+    parameters.addParameter(param::ParameterFactory::declareBool("guard/skip_infeasible", false));
+    parameters.addParameter(param::ParameterFactory::declareRange("guard/neighbors", 1, 20, 3, 1));
+    parameters.addParameter(param::ParameterFactory::declareRange("guard/radius", 0.0, 1.0, 0.05, 0.001));
+
+    // linear constraints like "a + 2 * b <= 10", separated by ';', interval bounds are named "<name>.low" and "<name>.high"
+    parameters.addParameter(param::ParameterFactory::declareText("constraints", ""));
+    parameters.addParameter(param::ParameterFactory::declareBool("constraints/repair", true));
+
+    parameters.addParameter(param::ParameterFactory::declareBool("trace/enabled", false));
+    parameters.addParameter(param::ParameterFactory::declareFileOutputPath("trace/file", ""));
+    parameters.addParameter(param::ParameterFactory::declareRange("trace/max_events", 1000, 10000000, 200000, 1000));
+
+    parameters.addParameter(param::ParameterFactory::declareRange("sensitivity/bins", 2, 32, 8, 1));
+    parameters.addParameter(param::ParameterFactory::declareRange("sensitivity/threshold", 0.0, 1.0, 0.01, 0.001));
+    parameters.addParameter(param::ParameterFactory::declareRange("sensitivity/freeze_at_generation", -1, 1024, -1, 1));
+    // continue the next run with the parameters frozen in the previous one instead of the full search space
+    parameters.addParameter(param::ParameterFactory::declareBool("sensitivity/keep_frozen", false));
+    parameters.addParameter(param::ParameterFactory::declareFileOutputPath("sensitivity/output", ""));
+    parameters.addParameter(param::ParameterFactory::declareTrigger("sensitivity/freeze"), [this](param::Parameter*) {
+        if(native_) {
+            awarn << "freezing parameters is only supported by the EvA2 methods" << std::endl;
+            return;
+        }
+        freeze_requested_ = true;
+    });
+    parameters.addParameter(param::ParameterFactory::declareTrigger("sensitivity/unfreeze"), [this](param::Parameter*) {
+        sensitivity_.unfreeze();
+    });
+
+    // parameter callbacks run in the thread that executes the node, so a headless start does not race with it
+    parameters.addParameter(param::ParameterFactory::declareTrigger("headless/start"), [this](param::Parameter*) {
+        try {
+            runOptimization();
+        } catch(const std::exception& e) {
+            aerr << "starting the optimization failed: " << e.what() << std::endl;
+        }
+    });
 }
 
 bool EvaOptimizer::generateNextParameterSet()
 {
     apex_assert(optimizer_);
 
-    if(!client_) {
-        aerr << "connection lost" << std::endl;
-        throw std::runtime_error("connection lost");
+    if(noise_.samples() > 0) {
+        if(noise_.needsMoreSamples()) {
+            // evaluate the same candidate again
+            beginEvaluation(false);
+            return true;
+        }
+
+        if(noise_.samples() > 1) {
+            ainfo << "candidate evaluated " << noise_.samples() << " times, mean " << noise_.mean()
+                  << ", variance " << noise_.variance() << std::endl;
+        }
+        noise_.accept();
+    }
+    noise_.begin();
+    if(noise_.isEnabled() && noise_.hasIncumbent()) {
+        best_fitness_ = noise_.incumbentMean();
     }
 
     // send fitness back to eva
-    requestNewValues(fitness_);
+    try {
+        proceed(fitness_);
+    } catch(...) {
+        markFailed();
+        throw;
+    }
+
+    return true;
+}
 
+void EvaOptimizer::proceed(double fitness)
+{
+    if(local_search_.isRunning()) {
+        nextLocalSearchCandidate(fitness);
+
+    } else if(native_) {
+        // the native methods are told that the candidate failed, the penalty is only meant for EvA2
+        native_->tell(native_x_, candidate_failed_ ? std::numeric_limits<double>::infinity() : fitness);
+
+        // refine after the generation that just ended, the result is injected before the next candidate is asked for
+        int generation = native_->getGeneration();
+        if(generation != native_generation_) {
+            int ended = native_generation_;
+            native_generation_ = generation;
+            if(native_->canContinue() && isLocalSearchDue(ended) &&
+                    startLocalSearch(LocalSearchPhase::Generation, fitness)) {
+                return;
+            }
+        }
+
+        nextNativeCandidate();
+
+    } else if(!client_) {
+        connectionLost("connection lost");
+
+    } else {
+        requestNewValues(fitness);
+    }
+}
+
+bool EvaOptimizer::setMethod(const std::string& name)
+{
+    std::map<std::string, Method> methods {
+        {"DE", Method::DE},
+        {"GA", Method::GA},
+        {"PSO", Method::PSO},
+        {"BO", Method::BO},
+        {"SSDE", Method::SSDE},
+        {"Portfolio", Method::Portfolio}
+    };
+
+    auto pos = methods.find(name);
+    if(pos == methods.end()) {
+        return false;
+    }
+
+    getParameter("method")->set<int>((int) pos->second);
     return true;
 }
 
+void EvaOptimizer::startOptimization()
+{
+    std::shared_ptr<param::TriggerParameter> trigger = std::dynamic_pointer_cast<param::TriggerParameter>(getParameter("headless/start"));
+    apex_assert(trigger);
+    trigger->trigger();
+}
+
+void EvaOptimizer::runOptimization()
+{
+    try {
+        start();
+    } catch(...) {
+        markFailed();
+        throw;
+    }
+}
+
+void EvaOptimizer::abortOptimization()
+{
+    std::unique_lock<std::recursive_mutex> lock(evaluation_mutex_);
+
+    // a pending watchdog timeout sees a new arming and does nothing
+    guard_.disarm();
+    evaluating_ = false;
+
+    if(finished_) {
+        return;
+    }
+
+    client_.reset();
+    native_running_ = false;
+
+    // the parameters still hold the candidate that was being evaluated
+    if(!report_.evaluations().empty()) {
+        applyBest();
+    }
+
+    if(!failed_) {
+        markFailed();
+    }
+}
+
+bool EvaOptimizer::hasFinished() const
+{
+    return finished_;
+}
+
+bool EvaOptimizer::hasFailed() const
+{
+    return failed_;
+}
+
+const OptimizationReport& EvaOptimizer::getReport() const
+{
+    return report_;
+}
+
+void EvaOptimizer::writeResults(const std::string& directory)
+{
+    report_.writeParameters(getPersistentParameters(), directory + "/best_parameters.yaml");
+    report_.writeRunLog(directory + "/run_log.csv");
+    report_.writeTiming(directory + "/timing.yaml");
+
+    if(optimizer_) {
+        YAML::Node statistics;
+        getStatistics(statistics);
+        if(statistics.size() > 0) {
+            report_.writeStatistics(statistics, directory + "/optimizer_statistics.yaml");
+        }
+    }
+}
+
+void EvaOptimizer::markFailed()
+{
+    report_.finish(false);
+    failed_ = true;
+
+    writeTrace();
+}
+
 
 
 void EvaOptimizer::requestNewValues(double fitness)
 {
-    ValueMsg<double>::Ptr msg(new ValueMsg<double>);
-    msg->set(fitness);
+    fitness_msg_->set(fitness);
 
-    client_->write(msg);
+    report_.beginServerRequest();
+    client_->write(fitness_msg_);
     handleResponse();
 }
 
 void EvaOptimizer::handleResponse()
 {
+    TraceScope trace(trace_, "handleResponse", currentIndividual());
+
     SocketMsg::Ptr res;
     client_->read(res);
+    report_.endServerRequest();
 
     if(!res) {
-        client_.reset();
-
-        throw std::runtime_error("could not read");
+        connectionLost("could not read");
     }
 
-    ValueMsg<double>::Ptr value = std::dynamic_pointer_cast<ValueMsg<double>>(res);
+    handleMessage(res);
+}
+
+void EvaOptimizer::handleMessage(const SocketMsg::Ptr& res)
+{
+    ValueMsg<double>* value = dynamic_cast<ValueMsg<double>*>(res.get());
     if(value) {
-        ainfo << "finished with fitness " << value->get() << std::endl;
-        stop();
+        if(restarting_) {
+            // the server finished the old session, continue with the reduced encoding
+            restarting_ = false;
+            client_.reset();
+            openSession();
+            return;
+        }
 
-        setBest();
+        if(readParameter<bool>("local_search/after_termination") &&
+                startLocalSearch(LocalSearchPhase::Final, value->get())) {
+            return;
+        }
+
+        completeRun(value->get());
         return;
     }
 
 
-    ErrorMsg::Ptr err = std::dynamic_pointer_cast<ErrorMsg>(res);
+    ErrorMsg* err = dynamic_cast<ErrorMsg*>(res.get());
     if(err) {
         client_.reset();
 
@@ -105,23 +367,25 @@ void EvaOptimizer::handleResponse()
     }
 
     // continue message?
-    VectorMsg<char>::Ptr string_message = std::dynamic_pointer_cast<VectorMsg<char> >(res);
+    VectorMsg<char>* string_message = dynamic_cast<VectorMsg<char>*>(res.get());
     if(string_message) {
-        std::string question(string_message->begin(), string_message->end());
-        if(question == "continue") {
-            VectorMsg<char>::Ptr continue_answer(new VectorMsg<char>);
-            if(optimizer_->canContinue()) {
-                continue_answer->assign("continue",8);
-                client_->write(continue_answer);
+        static const char continue_question[] = "continue";
+        if(string_message->size() == 8 &&
+                std::equal(string_message->begin(), string_message->end(), continue_question)) {
+            if(optimizer_->canContinue() && shouldFreeze() && freezeParameters()) {
+                // the encoding shrinks, so the server needs a new session
+                restarting_ = true;
+                client_->write(terminate_msg_);
+                handleResponse();
 
-                optimizer_->nextIteration();
+            } else if(optimizer_->canContinue() && isLocalSearchDue(optimizer_->getGeneration()) && startLocalSearch(LocalSearchPhase::Generation, fitness_)) {
+                // the server waits for the answer until the refinement is done
 
-                requestNewValues(fitness_);
-                handleResponse();
+            } else if(optimizer_->canContinue()) {
+                continueGeneration(fitness_);
 
             } else {
-                continue_answer->assign("terminate",9);
-                client_->write(continue_answer);
+                client_->write(terminate_msg_);
 
                 optimizer_->terminate();
             }
@@ -132,19 +396,412 @@ void EvaOptimizer::handleResponse()
     apex_assert(optimizer_);
 
     try {
-        optimizer_->decodeParameters(res, getPersistentParameters());
+        TraceScope trace(trace_, "decodeParameters", currentIndividual());
+        optimizer_->decodeParameters(res, persistent_params_);
+
+    } catch(const InfeasibleCandidate& e) {
+        rejectInfeasibleCandidate(e.what());
+        return;
+
+    } catch(const std::exception& e) {
+        if(!rejectFailedCandidate(e.what())) {
+            client_.reset();
+            throw;
+        }
+        return;
+
     } catch(...) {
         client_.reset();
         throw;
     }
+
+    beginEvaluation();
+}
+
+void EvaOptimizer::beginEvaluation(bool new_candidate)
+{
+    if(new_candidate) {
+        guard_.readCandidate();
+
+        if(skip_infeasible_ && consecutive_rejections_ < MAX_CONSECUTIVE_REJECTIONS &&
+                guard_.predictFailure()) {
+            ++consecutive_rejections_;
+            ainfo << "skipping a candidate that is close to known failures" << std::endl;
+            rejectCandidate();
+            return;
+        }
+    }
+
+    consecutive_rejections_ = 0;
+    candidate_failed_ = false;
+
+    report_.beginEvaluation();
+    evaluation_begin_ = trace_.now();
+    evaluating_ = true;
+    guard_.arm();
+}
+
+bool EvaOptimizer::applyCandidate(const ParameterLayout& layout, const std::vector<double>& values)
+{
+    // the optimizer keeps its own copy, it learns the fitness of the repaired candidate
+    candidate_ = values;
+    bool feasible = true;
+    if(repair_constraints_) {
+        feasible = constraints_.repair(layout, candidate_.data());
+    } else {
+        layout.repair(candidate_.data());
+        feasible = constraints_.isFeasible(layout, candidate_.data());
+    }
+
+    if(!feasible) {
+        rejectInfeasibleCandidate("candidate violates the constraints");
+        return false;
+    }
+
+    try {
+        layout.apply(candidate_.data());
+
+    } catch(const std::exception& e) {
+        if(!rejectFailedCandidate(e.what())) {
+            throw;
+        }
+        return false;
+    }
+
+    beginEvaluation();
+    return true;
+}
+
+bool EvaOptimizer::rejectFailedCandidate(const std::string& reason)
+{
+    if(!readParameter<bool>("guard/enabled") || consecutive_rejections_ >= MAX_CONSECUTIVE_REJECTIONS) {
+        return false;
+    }
+
+    awarn << "candidate failed: " << reason << std::endl;
+
+    guard_.readCandidate();
+    guard_.addFailure();
+
+    ++consecutive_rejections_;
+    rejectCandidate();
+    return true;
+}
+
+void EvaOptimizer::rejectCandidate()
+{
+    // the candidate is never evaluated, the backend gets the penalty right away
+    double penalty = readParameter<double>("guard/penalty");
+    report_.endEvaluation(optimizer_->getGeneration(), penalty, best_fitness_);
+    candidate_failed_ = true;
+
+    noise_.begin();
+    proceed(penalty);
+}
+
+void EvaOptimizer::onEvaluationTimeout(unsigned long arming)
+{
+    std::unique_lock<std::recursive_mutex> lock(evaluation_mutex_);
+
+    // the result may have arrived between the timeout and this lock, then the next candidate is armed
+    if(!guard_.isCurrent(arming)) {
+        return;
+    }
+
+    // runs on the watchdog thread, nothing may escape from here
+    try {
+        awarn << "evaluation timed out, using the penalty fitness" << std::endl;
+
+        guard_.addFailure();
+
+        // results carry no candidate id, so a result that is merely late cannot be told apart from the
+        // result of the next candidate; graph exceptions never deliver one, so nothing is dropped here
+        fitness_ = readParameter<double>("guard/penalty");
+        completeEvaluation(false);
+
+    } catch(const std::exception& e) {
+        aerr << "handling the timeout failed: " << e.what() << std::endl;
+        markFailed();
+
+    } catch(...) {
+        aerr << "handling the timeout failed" << std::endl;
+        markFailed();
+    }
+}
+
+void EvaOptimizer::configureGuard()
+{
+    guard_.configure(readParameter<bool>("guard/enabled") ? readParameter<double>("guard/timeout") : 0.0,
+                     readParameter<int>("guard/neighbors"),
+                     readParameter<double>("guard/radius"),
+                     1000);
+    guard_.setParameters(getPersistentParameters());
+    skip_infeasible_ = readParameter<bool>("guard/skip_infeasible");
+
+    consecutive_rejections_ = 0;
+    evaluating_ = false;
+}
+
+void EvaOptimizer::configureConstraints()
+{
+    constraints_.clear();
+    constraints_.parse(readParameter<std::string>("constraints"));
+
+    // frozen parameters are still valid names, they enter the constraints with their current value
+    constraints_.setParameters(getPersistentParameters());
+    if(!constraints_.empty()) {
+        constraints_.validate();
+
+        ainfo << "optimizing with " << constraints_.size() << " constraints" << std::endl;
+    }
+
+    // without repair, the backends only fix bounds and interval order and reject the rest before applying it
+    repair_constraints_ = readParameter<bool>("constraints/repair");
+    optimizer_->setConstraints(constraints_.empty() ? nullptr : &constraints_, repair_constraints_);
+}
+
+void EvaOptimizer::rejectInfeasibleCandidate(const std::string& reason)
+{
+    if(consecutive_rejections_ >= MAX_CONSECUTIVE_REJECTIONS) {
+        throw std::runtime_error("no feasible candidate in " + std::to_string(MAX_CONSECUTIVE_REJECTIONS) +
+                                 " attempts, the constraints may be contradictory");
+    }
+
+    ainfo << "rejecting an infeasible candidate: " << reason << std::endl;
+
+    ++consecutive_rejections_;
+    rejectCandidate();
+}
+
+long EvaOptimizer::currentIndividual() const
+{
+    return report_.evaluations().size();
+}
+
+void EvaOptimizer::writeTrace()
+{
+    if(!trace_.isEnabled()) {
+        return;
+    }
+
+    trace_.stop();
+
+    std::string path = readParameter<std::string>("trace/file");
+    if(!path.empty()) {
+        trace_.write(path);
+    }
 }
 
 void EvaOptimizer::finish()
 {
+    std::unique_lock<std::recursive_mutex> lock(evaluation_mutex_);
+
+    if(!evaluating_) {
+        awarn << "dropping a result that arrived while no candidate was evaluated" << std::endl;
+        return;
+    }
+
+    guard_.disarm();
+    guard_.addSuccess();
+
+    completeEvaluation(true);
+}
+
+void EvaOptimizer::completeEvaluation(bool success)
+{
+    evaluating_ = false;
+
+    trace_.span("evaluation", evaluation_begin_, trace_.now(), currentIndividual());
+    TraceScope trace(trace_, "finish", currentIndividual());
+
+    bool first_sample = true;
+    if(success) {
+        sensitivity_.addSample(fitness_);
+
+        // the backends and the best set see the mean of all samples of the current candidate
+        noise_.addSample(fitness_);
+        fitness_ = noise_.mean();
+        first_sample = noise_.samples() == 1;
+
+    } else {
+        // a failed candidate is never sampled again and its penalty says nothing about the noise
+        noise_.begin();
+        candidate_failed_ = true;
+    }
+
+    // refinement steps and repeated samples are not part of the population
+    bool refining = local_search_.isRunning();
+
     Optimizer::finish();
 
     if(optimizer_) {
-        optimizer_->finish(fitness_, best_fitness_, worst_fitness_);
+        report_.endEvaluation(optimizer_->getGeneration(), fitness_, best_fitness_);
+        if(!refining && first_sample) {
+            updatePopulationSize();
+            population_.addSample(fitness_);
+
+            optimizer_->finish(fitness_, best_fitness_, worst_fitness_);
+        }
+    }
+}
+
+void EvaOptimizer::continueGeneration(double fitness)
+{
+    client_->write(continue_msg_);
+
+    {
+        TraceScope trace(trace_, "nextIteration", -1);
+        optimizer_->nextIteration();
+    }
+    trace_.instant("generation", -1);
+
+    requestNewValues(fitness);
+    handleResponse();
+}
+
+void EvaOptimizer::completeRun(double fitness)
+{
+    ainfo << "finished with fitness " << fitness << std::endl;
+    stop();
+
+    YAML::Node statistics;
+    getStatistics(statistics);
+    if(statistics.size() > 0) {
+        ainfo << "optimizer statistics:\n" << statistics << std::endl;
+    }
+
+    analyzeSensitivity();
+
+    applyBest();
+
+    report_.finish(true);
+    finished_ = true;
+    native_running_ = false;
+
+    writeTrace();
+}
+
+void EvaOptimizer::applyBest()
+{
+    if(noise_.isEnabled() && noise_.hasIncumbent()) {
+        // a single lucky sample must not win over a candidate with a better mean
+        noise_.applyIncumbent();
+        best_fitness_ = noise_.incumbentMean();
+    } else {
+        setBest();
+    }
+}
+
+void EvaOptimizer::configureNoiseHandling()
+{
+    noise_.configure(static_cast<NoiseHandler::Mode>(readParameter<int>("noise/mode")),
+                     readParameter<int>("noise/max_samples"),
+                     readParameter<double>("noise/confidence"),
+                     readParameter<double>("noise/tolerance"));
+    noise_.setParameters(getPersistentParameters());
+    noise_.reset();
+}
+
+void EvaOptimizer::configurePopulationSizing()
+{
+    population_.configure(readParameter<bool>("population/adaptive"),
+                          readParameter<int>("population/min"),
+                          readParameter<int>("population/max"));
+    population_.setParameters(getPersistentParameters());
+    population_.reset();
+    population_generation_ = 0;
+
+    if(population_.isAdaptive() && !optimizer_->canResizePopulation()) {
+        awarn << "the population size of " << optimizer_->getName()
+              << " cannot change during a run, only the diversity is recorded" << std::endl;
+    }
+}
+
+void EvaOptimizer::updatePopulationSize()
+{
+    // the first result of a new generation closes the previous one
+    int generation = optimizer_->getGeneration();
+    if(generation == population_generation_) {
+        return;
+    }
+
+    const PopulationSizer::Generation& g = population_.closeGeneration(population_generation_,
+                                                                       optimizer_->getPopulationSize());
+    population_generation_ = generation;
+
+    ainfo << "generation " << g.generation << ": diversity " << g.diversity
+          << ", fitness spread " << g.fitness_spread << std::endl;
+
+    if(population_.isAdaptive() && optimizer_->canResizePopulation() && g.next_size != g.size) {
+        ainfo << "population size " << g.size << " -> " << g.next_size << std::endl;
+        optimizer_->setPopulationSize(g.next_size);
+    }
+}
+
+void EvaOptimizer::getStatistics(YAML::Node& statistics) const
+{
+    optimizer_->getStatistics(statistics);
+    population_.getStatistics(statistics);
+}
+
+bool EvaOptimizer::isLocalSearchDue(int generation) const
+{
+    int every = readParameter<int>("local_search/every_generations");
+    return every > 0 && (generation + 1) % every == 0;
+}
+
+bool EvaOptimizer::startLocalSearch(LocalSearchPhase phase, double fitness)
+{
+    if(!local_search_layout_.matches(persistent_params_)) {
+        local_search_layout_.build(persistent_params_);
+    }
+
+    // start from the best individual found so far
+    applyBest();
+    local_search_layout_.read(local_search_x_);
+
+    local_search_.start(local_search_layout_, local_search_x_, best_fitness_,
+                        readParameter<int>("local_search/budget"));
+    if(!local_search_.ask(local_search_x_)) {
+        return false;
+    }
+
+    local_search_phase_ = phase;
+    if(phase == LocalSearchPhase::Generation) {
+        deferred_fitness_ = fitness;
+    } else {
+        final_fitness_ = fitness;
+    }
+
+    applyCandidate(local_search_layout_, local_search_x_);
+    return true;
+}
+
+void EvaOptimizer::nextLocalSearchCandidate(double fitness)
+{
+    local_search_.tell(fitness);
+
+    if(local_search_.ask(local_search_x_)) {
+        applyCandidate(local_search_layout_, local_search_x_);
+        return;
+    }
+
+    ainfo << "local search improved the fitness to " << local_search_.bestFitness()
+          << " with " << local_search_.evaluations() << " evaluations" << std::endl;
+
+    optimizer_->injectIndividual(local_search_.best(), local_search_.bestFitness());
+
+    switch(local_search_phase_) {
+    case LocalSearchPhase::Generation:
+        if(native_) {
+            nextNativeCandidate();
+        } else {
+            continueGeneration(deferred_fitness_);
+        }
+        break;
+    case LocalSearchPhase::Final:
+        completeRun(std::min(final_fitness_, local_search_.bestFitness()));
+        break;
     }
 }
 
@@ -158,78 +815,258 @@ void EvaOptimizer::reset()
 
 void EvaOptimizer::start()
 {
+    // the recorder is only enabled below, so the span is recorded by hand
+    TraceRecorder::Clock::time_point begin = trace_.now();
+
     // initilization?
-    if(!client_) {
-        tryMakeSocket();
+    if(native_ ? !native_running_ : !client_) {
+        sensitivity_.setParameters(getPersistentParameters());
+        sensitivity_.clear();
+        if(!readParameter<bool>("sensitivity/keep_frozen")) {
+            sensitivity_.unfreeze();
+        }
+
+        makeSeed();
+        optimizer_->setSeed(seed_);
+
+        report_.reset(optimizer_->getName(), replaySeed());
 
-        if(!client_) {
-            throw std::runtime_error("couldn't create client");
+        // the run log and the sensitivity samples grow with every evaluation
+        int budget = optimizer_->getEvaluationBudget();
+        if(budget > 0) {
+            report_.reserve(budget);
+            sensitivity_.reserve(budget);
+        }
+        finished_ = false;
+        failed_ = false;
+
+        if(readParameter<bool>("trace/enabled")) {
+            trace_.start(readParameter<int>("trace/max_events"), replaySeed());
         } else {
-            ainfo << "client initialized" << std::endl;
+            trace_.stop();
         }
 
-        if(!client_->isConnected()) {
-            if(!client_->connect()) {
-                aerr << "could not connect to EvA2" << std::endl;
-                throw std::runtime_error("Couldn't connect!");
-                client_.reset();
+        configureNoiseHandling();
+        configurePopulationSizing();
+        configureGuard();
+        configureConstraints();
+
+        if(native_) {
+            // the native methods size their state by the layout once, they cannot drop parameters during a run
+            if(readParameter<int>("sensitivity/freeze_at_generation") >= 0) {
+                awarn << "sensitivity/freeze_at_generation is ignored by " << optimizer_->getName()
+                      << ", only the EvA2 methods can freeze parameters during a run" << std::endl;
             }
+            freeze_requested_ = false;
+
+            if(readParameter<int>("local_search/every_generations") > 0 &&
+                    (method_ == Method::BO || method_ == Method::Portfolio)) {
+                awarn << optimizer_->getName() << " has no generations, local_search/every_generations is ignored" << std::endl;
+            }
+
+            startNativeRun();
+
+        } else {
+            openSession();
         }
+    }
 
-        // connect to eva
-        SocketMsg::Ptr res;
-        if(client_->read(res)) {
-            ErrorMsg::Ptr err = std::dynamic_pointer_cast<ErrorMsg>(res);
-            VectorMsg<char>::Ptr welcome = std::dynamic_pointer_cast<VectorMsg<char> >(res);
+    trace_.span("start", begin, trace_.now(), -1);
 
-            if(err) {
-                client_.reset();
+    Optimizer::start();
+}
 
-                std::stringstream ss;
-                ss << "Got error [ " << err->get() << " ]";
-                throw std::runtime_error(ss.str());
-            }
+void EvaOptimizer::startNativeRun()
+{
+    updateEncodedParameters();
 
-            if(welcome) {
-                //                ainfo << "connection established: " << std::string(welcome->begin(), welcome->end()) << std::endl;
+    // native optimizers keep their state between runs otherwise
+    native_->reset();
 
-                // generate request
-                YAML::Node description;
-                description["method"] = optimizer_->getName();
+    YAML::Node description;
+    native_->encodeParameters(persistent_params_, description);
 
-                YAML::Node options;
-                optimizer_->getOptions(options);
-                description["options"] = options;
+    native_running_ = true;
+    native_generation_ = 0;
+    nextNativeCandidate();
+}
 
-                optimizer_->encodeParameters(getPersistentParameters(), description);
-                //                ainfo << "optimization request:\n" << description << std::endl;
+void EvaOptimizer::nextNativeCandidate()
+{
+    if(native_->ask(native_x_)) {
+        applyCandidate(native_->getLayout(), native_x_);
+        return;
+    }
 
-                // send parameter description
-                SocketMsg::Ptr res;
-                VectorMsg<char>::Ptr config(new VectorMsg<char>);
-                std::stringstream config_ss;
-                config_ss << description;
+    if(readParameter<bool>("local_search/after_termination") &&
+            startLocalSearch(LocalSearchPhase::Final, best_fitness_)) {
+        return;
+    }
 
-                std::string yaml = config_ss.str();
-                config->assign(yaml.data(), yaml.size());
+    completeRun(best_fitness_);
+}
 
-                ainfo << "write config " << std::endl;
-                client_->write(config);
+void EvaOptimizer::openSession()
+{
+    tryMakeSocket();
 
-                handleResponse();
+    if(!client_) {
+        throw std::runtime_error("couldn't create client");
+    } else {
+        ainfo << "client initialized" << std::endl;
+    }
+
+    if(!client_->isConnected()) {
+        if(!client_->connect()) {
+            aerr << "could not connect to EvA2" << std::endl;
+            throw std::runtime_error("Couldn't connect!");
+            client_.reset();
+        }
+    }
+
+    // connect to eva
+    SocketMsg::Ptr res;
+    if(client_->read(res)) {
+        ErrorMsg::Ptr err = std::dynamic_pointer_cast<ErrorMsg>(res);
+        VectorMsg<char>::Ptr welcome = std::dynamic_pointer_cast<VectorMsg<char> >(res);
+
+        if(err) {
+            client_.reset();
+
+            std::stringstream ss;
+            ss << "Got error [ " << err->get() << " ]";
+            throw std::runtime_error(ss.str());
+        }
+
+        if(welcome) {
+            //                ainfo << "connection established: " << std::string(welcome->begin(), welcome->end()) << std::endl;
+
+            // generate request
+            YAML::Node description;
+            description["method"] = optimizer_->getName();
+
+            YAML::Node options;
+            optimizer_->getOptions(options);
+            description["options"] = options;
+
+            updateEncodedParameters();
+            optimizer_->encodeParameters(persistent_params_, description);
+            //                ainfo << "optimization request:\n" << description << std::endl;
+
+            // send parameter description
+            SocketMsg::Ptr res;
+            VectorMsg<char>::Ptr config(new VectorMsg<char>);
+            std::stringstream config_ss;
+            config_ss << description;
+
+            std::string yaml = config_ss.str();
+            config->assign(yaml.data(), yaml.size());
+
+            ainfo << "write config " << std::endl;
+            report_.beginServerRequest();
+            client_->write(config);
+
+            handleResponse();
 
-            } else {
-                aerr << "didn't receive a welcome message" << std::endl;
-                client_.reset();
-            }
         } else {
-            aerr << "socket error" << std::endl;
+            aerr << "didn't receive a welcome message" << std::endl;
             client_.reset();
-            throw std::runtime_error("socket error");
         }
+    } else {
+        aerr << "socket error" << std::endl;
+        client_.reset();
+        throw std::runtime_error("socket error");
     }
+}
 
-    Optimizer::start();
+void EvaOptimizer::makeSeed()
+{
+    int seed = readParameter<int>("seed");
+    if(seed == 0) {
+        // stays in the range of the parameter, so the run can be replayed by entering the seed
+        std::random_device rd;
+        std::uniform_int_distribution<int> dist(1, std::numeric_limits<int>::max());
+        seed = dist(rd);
+    }
+    seed_ = static_cast<std::uint32_t>(seed);
+
+    if(native_) {
+        ainfo << "random seed: " << seed_ << std::endl;
+    } else if(readParameter<int>("seed") != 0) {
+        // EvA2 draws its own random numbers, these runs cannot be replayed
+        awarn << "the seed is ignored by " << optimizer_->getName() << ", the run cannot be replayed" << std::endl;
+    }
+}
+
+std::uint64_t EvaOptimizer::replaySeed() const
+{
+    return native_ ? seed_ : 0;
+}
+
+void EvaOptimizer::connectionLost(const std::string& reason)
+{
+    /*
+     * The bundled EvA2 server ties a session to its connection, a new connection always starts a new run.
+     * Continuing that run would mix it with the best individual, noise statistics, sensitivity samples
+     * and report of the lost one, so the run fails instead. Resuming needs a protocol extension that
+     * a server has to implement first:
+     *  - the configuration carries a session id and the number of fitness values the node has sent,
+     *  - the server answers "resumed" instead of sending the first individual if it re-attached,
+     *  - the node sends the fitness of the candidate in flight again, the server drops it if it was counted.
+     */
+    client_.reset();
+    aerr << reason << ", EvA2 cannot resume the session, the run has to be restarted" << std::endl;
+    throw std::runtime_error(reason);
+}
+
+void EvaOptimizer::updateEncodedParameters()
+{
+    persistent_params_.clear();
+    for(const param::ParameterPtr& p : getPersistentParameters()) {
+        if(!sensitivity_.isFrozen(p.get())) {
+            persistent_params_.push_back(p);
+        }
+    }
+}
+
+bool EvaOptimizer::shouldFreeze() const
+{
+    int freeze_at = readParameter<int>("sensitivity/freeze_at_generation");
+    return freeze_requested_ || (freeze_at >= 0 && optimizer_->getGeneration() == freeze_at);
+}
+
+bool EvaOptimizer::freezeParameters()
+{
+    freeze_requested_ = false;
+
+    analyzeSensitivity();
+
+    std::size_t frozen = sensitivity_.freeze(readParameter<double>("sensitivity/threshold"));
+    if(frozen == 0) {
+        return false;
+    }
+
+    ainfo << "freezing " << frozen << " parameters with low importance" << std::endl;
+
+    // frozen parameters keep the best value found so far
+    applyBest();
+
+    exportSensitivity();
+    return true;
+}
+
+void EvaOptimizer::analyzeSensitivity()
+{
+    sensitivity_.analyze(readParameter<int>("sensitivity/bins"));
+    exportSensitivity();
+}
+
+void EvaOptimizer::exportSensitivity()
+{
+    std::string path = readParameter<std::string>("sensitivity/output");
+    if(!path.empty()) {
+        sensitivity_.exportCsv(path, replaySeed());
+    }
 }
 
 void EvaOptimizer::updateOptimizer()
@@ -254,8 +1091,23 @@ void EvaOptimizer::updateOptimizer()
         case Method::GA:
             optimizer_ = std::make_shared<OptimizerGA>();
             break;
+        case Method::PSO:
+            optimizer_ = std::make_shared<OptimizerPSO>();
+            break;
+        case Method::BO:
+            optimizer_ = std::make_shared<OptimizerBO>();
+            break;
+        case Method::SSDE:
+            optimizer_ = std::make_shared<OptimizerSSDE>();
+            break;
+        case Method::Portfolio:
+            optimizer_ = std::make_shared<OptimizerPortfolio>();
+            break;
         }
 
+        native_ = std::dynamic_pointer_cast<NativeOptimizer>(optimizer_);
+        native_running_ = false;
+
         optimizer_->addParameters(*this);
     }
 }
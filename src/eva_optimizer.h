@@ -7,6 +7,19 @@
 #include <csapex/signal/signal_fwd.h>
 #include <cslibs_jcppsocket/cpp/sync_client.h>
 #include "abstract_optimizer.h"
+#include "native_optimizer.h"
+#include "optimization_report.h"
+#include "parameter_sensitivity.h"
+#include "local_search.h"
+#include "noise_handler.h"
+#include "trace_recorder.h"
+#include "evaluation_guard.h"
+#include "constraint_set.h"
+#include "population_sizer.h"
+
+/// SYSTEM
+#include <atomic>
+#include <mutex>
 
 namespace csapex {
 
@@ -19,7 +32,17 @@ class EvaOptimizer : public Optimizer
     {
         None,
         DE,
-        GA
+        GA,
+        PSO,
+        BO,
+        SSDE,
+        Portfolio
+    };
+
+    enum class LocalSearchPhase
+    {
+        Generation,
+        Final
     };
 
 public:
@@ -28,6 +51,26 @@ public:
     virtual void setupParameters(Parameterizable& parameters) override;
     virtual bool generateNextParameterSet() override;
 
+    // headless control
+    bool setMethod(const std::string& name);
+
+    /**
+     * @brief startOptimization requests a run, it starts in the thread that executes the node
+     */
+    void startOptimization();
+
+    /**
+     * @brief abortOptimization ends an unfinished run and applies the best parameters found so far,
+     * the graph must not execute the node anymore
+     */
+    void abortOptimization();
+
+    bool hasFinished() const;
+    bool hasFailed() const;
+
+    const OptimizationReport& getReport() const;
+    void writeResults(const std::string& directory);
+
 private:
     void tryMakeSocket();
     void makeSocket();
@@ -35,21 +78,117 @@ private:
 private:
     void reset();
     void start() override;
+    void runOptimization();
+    void startNativeRun();
+    void nextNativeCandidate();
+    void openSession();
+    [[noreturn]] void connectionLost(const std::string& reason);
+    void makeSeed();
+    std::uint64_t replaySeed() const;
+    void updateEncodedParameters();
 
     void finish();
 
+    void completeEvaluation(bool success);
+
+    void proceed(double fitness);
+
+    void beginEvaluation(bool new_candidate = true);
+    bool applyCandidate(const ParameterLayout& layout, const std::vector<double>& values);
+    bool rejectFailedCandidate(const std::string& reason);
+    void rejectCandidate();
+    void onEvaluationTimeout(unsigned long arming);
+    void configureGuard();
+
+    void configureConstraints();
+    void rejectInfeasibleCandidate(const std::string& reason);
+
+    long currentIndividual() const;
+    void writeTrace();
+
+    void continueGeneration(double fitness);
+    void completeRun(double fitness);
+
+    void applyBest();
+    void configureNoiseHandling();
+
+    void configurePopulationSizing();
+    void updatePopulationSize();
+    void getStatistics(YAML::Node& statistics) const;
+
+    bool isLocalSearchDue(int generation) const;
+    bool startLocalSearch(LocalSearchPhase phase, double fitness);
+    void nextLocalSearchCandidate(double fitness);
 
     void handleResponse();
+    void handleMessage(const cslibs_jcppsocket::SocketMsg::Ptr& res);
     void requestNewValues(double fitness);
 
     void updateOptimizer();
+    void markFailed();
+
+    bool shouldFreeze() const;
+    bool freezeParameters();
+    void analyzeSensitivity();
+    void exportSensitivity();
 
 private:
     Method method_;
 
     std::shared_ptr<AbstractOptimizer> optimizer_;
 
+    std::shared_ptr<NativeOptimizer> native_;
+    bool native_running_;
+    std::vector<double> native_x_;
+    int native_generation_;
+
     cslibs_jcppsocket::SyncClient::Ptr client_;
+
+    std::vector<param::ParameterPtr> persistent_params_;
+
+    std::uint64_t seed_;
+
+    OptimizationReport report_;
+    std::atomic<bool> finished_;
+    std::atomic<bool> failed_;
+
+    ParameterSensitivity sensitivity_;
+    bool freeze_requested_;
+    bool restarting_;
+
+    LocalSearch local_search_;
+    ParameterLayout local_search_layout_;
+    std::vector<double> local_search_x_;
+    LocalSearchPhase local_search_phase_;
+    double deferred_fitness_;
+    double final_fitness_;
+
+    NoiseHandler noise_;
+
+    PopulationSizer population_;
+    int population_generation_;
+
+    TraceRecorder trace_;
+    TraceRecorder::Clock::time_point evaluation_begin_;
+
+    cslibs_jcppsocket::ValueMsg<double>::Ptr fitness_msg_;
+    cslibs_jcppsocket::VectorMsg<char>::Ptr continue_msg_;
+    cslibs_jcppsocket::VectorMsg<char>::Ptr terminate_msg_;
+
+    // declared before the guard, its watchdog thread may still lock it while the guard is destroyed
+    std::recursive_mutex evaluation_mutex_;
+    EvaluationGuard guard_;
+    bool evaluating_;
+    int consecutive_rejections_;
+    bool candidate_failed_;
+    bool skip_infeasible_;
+
+    ConstraintSet constraints_;
+    bool repair_constraints_;
+    std::vector<double> candidate_;
+
+    // keeps a run that only produces failures from recursing forever
+    static const int MAX_CONSECUTIVE_REJECTIONS = 100;
 };
 
 
@@ -0,0 +1,178 @@
+#include "evaluation_guard.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace csapex;
+
+EvaluationGuard::EvaluationGuard(std::function<void(unsigned long)> on_timeout)
+    : on_timeout_(on_timeout),
+      timeout_(0.0), neighbors_(3), radius_(0.05), memory_(1000),
+      next_failure_(0), next_success_(0),
+      armed_(false), running_(true), generation_(0)
+{
+    watchdog_ = std::thread([this]() {
+        watch();
+    });
+}
+
+EvaluationGuard::~EvaluationGuard()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    changed_.notify_all();
+    watchdog_.join();
+}
+
+void EvaluationGuard::configure(double timeout, int neighbors, double radius, std::size_t memory)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    timeout_ = timeout;
+    neighbors_ = neighbors;
+    radius_ = radius;
+    memory_ = memory;
+}
+
+void EvaluationGuard::setParameters(const std::vector<param::ParameterPtr>& params)
+{
+    if(!layout_.matches(params)) {
+        layout_.build(params);
+        reset();
+    }
+}
+
+void EvaluationGuard::reset()
+{
+    failures_.clear();
+    successes_.clear();
+    next_failure_ = 0;
+    next_success_ = 0;
+}
+
+void EvaluationGuard::arm()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        armed_ = timeout_ > 0.0;
+        ++generation_;
+    }
+    changed_.notify_all();
+}
+
+void EvaluationGuard::disarm()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        armed_ = false;
+        ++generation_;
+    }
+    changed_.notify_all();
+}
+
+bool EvaluationGuard::isCurrent(unsigned long arming)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return generation_ == arming;
+}
+
+void EvaluationGuard::watch()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(running_) {
+        if(!armed_) {
+            changed_.wait(lock);
+            continue;
+        }
+
+        unsigned long generation = generation_;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(timeout_));
+
+        changed_.wait_until(lock, deadline, [&]() {
+            return !running_ || generation_ != generation;
+        });
+
+        if(running_ && armed_ && generation_ == generation) {
+            armed_ = false;
+
+            // the callback may arm the guard for the next candidate
+            lock.unlock();
+            on_timeout_(generation);
+            lock.lock();
+        }
+    }
+}
+
+void EvaluationGuard::readCandidate()
+{
+    layout_.read(candidate_);
+
+    std::size_t n = layout_.size();
+    normalized_.resize(n);
+    for(std::size_t d = 0; d < n; ++d) {
+        const ParameterLayout::Slot& slot = layout_[d];
+        double range = slot.max - slot.min;
+        normalized_[d] = range > 0.0 ? (candidate_[d] - slot.min) / range : 0.0;
+    }
+}
+
+void EvaluationGuard::addFailure()
+{
+    remember(failures_, next_failure_);
+}
+
+void EvaluationGuard::addSuccess()
+{
+    remember(successes_, next_success_);
+}
+
+void EvaluationGuard::remember(std::vector<double>& memory, std::size_t& next)
+{
+    std::size_t n = normalized_.size();
+    if(n == 0) {
+        return;
+    }
+
+    if(memory.size() < memory_ * n) {
+        memory.insert(memory.end(), normalized_.begin(), normalized_.end());
+    } else {
+        // ring buffer, the oldest entry is overwritten
+        std::copy(normalized_.begin(), normalized_.end(), memory.begin() + next * n);
+        next = (next + 1) % memory_;
+    }
+}
+
+bool EvaluationGuard::predictFailure() const
+{
+    std::size_t n = normalized_.size();
+    if(n == 0 || neighbors_ <= 0 || failures_.size() < (std::size_t) neighbors_ * n) {
+        return false;
+    }
+
+    distances_.clear();
+    auto collect = [&](const std::vector<double>& memory, bool failed) {
+        for(std::size_t i = 0; i < memory.size(); i += n) {
+            double d2 = 0.0;
+            for(std::size_t d = 0; d < n; ++d) {
+                double diff = memory[i + d] - normalized_[d];
+                d2 += diff * diff;
+            }
+            distances_.emplace_back(std::sqrt(d2 / n), failed);
+        }
+    };
+    collect(failures_, true);
+    collect(successes_, false);
+
+    std::size_t k = std::min<std::size_t>(neighbors_, distances_.size());
+    std::partial_sort(distances_.begin(), distances_.begin() + k, distances_.end());
+
+    for(std::size_t i = 0; i < k; ++i) {
+        if(!distances_[i].second || distances_[i].first > radius_) {
+            return false;
+        }
+    }
+    return true;
+}
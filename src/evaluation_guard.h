@@ -0,0 +1,80 @@
+#ifndef EVALUATION_GUARD_H
+#define EVALUATION_GUARD_H
+
+#include "parameter_layout.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace csapex
+{
+
+/**
+ * @brief The EvaluationGuard class protects a run against candidates that make the graph fail.
+ *
+ * A watchdog thread calls the timeout callback when an evaluation takes longer than allowed. The
+ * callback gets the arming that timed out, a result may still arrive before the callback gets to
+ * handle it, which isCurrent() tells apart.
+ * Failed and successful candidates are remembered in normalized parameter space, and a candidate
+ * whose nearest known neighbors all failed is predicted to fail as well.
+ */
+class EvaluationGuard
+{
+public:
+    EvaluationGuard(std::function<void(unsigned long)> on_timeout);
+    ~EvaluationGuard();
+
+    void configure(double timeout, int neighbors, double radius, std::size_t memory);
+    void setParameters(const std::vector<param::ParameterPtr>& params);
+    void reset();
+
+    void arm();
+    void disarm();
+
+    /**
+     * @brief isCurrent checks that the guard was not armed or disarmed again since the given arming
+     */
+    bool isCurrent(unsigned long arming);
+
+    void readCandidate();
+    void addFailure();
+    void addSuccess();
+    bool predictFailure() const;
+
+private:
+    void watch();
+    void remember(std::vector<double>& memory, std::size_t& next);
+
+private:
+    std::function<void(unsigned long)> on_timeout_;
+
+    double timeout_;
+    int neighbors_;
+    double radius_;
+    std::size_t memory_;
+
+    ParameterLayout layout_;
+    std::vector<double> candidate_;
+    std::vector<double> normalized_;
+
+    std::vector<double> failures_;
+    std::size_t next_failure_;
+    std::vector<double> successes_;
+    std::size_t next_success_;
+
+    mutable std::vector<std::pair<double, bool>> distances_;
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    bool armed_;
+    bool running_;
+    unsigned long generation_;
+    std::thread watchdog_;
+};
+
+}
+
+#endif // EVALUATION_GUARD_H
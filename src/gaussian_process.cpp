@@ -0,0 +1,235 @@
+#include "gaussian_process.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using namespace csapex;
+
+GaussianProcess::GaussianProcess()
+    : dimension_(0), capacity_(0), inv_length_scale_sq_(1.0), noise_(1e-6),
+      n_(0), y_mean_(0.0), y_scale_(1.0)
+{
+
+}
+
+void GaussianProcess::configure(std::size_t dimension, std::size_t capacity, double length_scale, double noise)
+{
+    dimension_ = dimension;
+    capacity_ = capacity;
+    inv_length_scale_sq_ = 1.0 / (length_scale * length_scale);
+    noise_ = noise;
+
+    x_.resize(capacity_ * dimension_);
+    y_.resize(capacity_);
+    chol_.resize(capacity_ * capacity_);
+    alpha_.resize(capacity_);
+    k_.resize(capacity_);
+    tmp_.resize(capacity_);
+
+    clear();
+}
+
+void GaussianProcess::clear()
+{
+    n_ = 0;
+    y_mean_ = 0.0;
+    y_scale_ = 1.0;
+}
+
+std::size_t GaussianProcess::size() const
+{
+    return n_;
+}
+
+std::size_t GaussianProcess::capacity() const
+{
+    return capacity_;
+}
+
+void GaussianProcess::add(const double* x, double y)
+{
+    if(n_ >= capacity_) {
+        throw std::runtime_error("gaussian process is full");
+    }
+
+    for(std::size_t i = 0; i < n_; ++i) {
+        k_[i] = kernel(&x_[i * dimension_], x);
+    }
+    solveLower(k_, n_);
+
+    double sq = 0.0;
+    for(std::size_t i = 0; i < n_; ++i) {
+        L(n_, i) = k_[i];
+        sq += k_[i] * k_[i];
+    }
+    L(n_, n_) = std::sqrt(std::max(1.0 + noise_ - sq, 1e-12));
+
+    std::copy(x, x + dimension_, &x_[n_ * dimension_]);
+    y_[n_] = y;
+    ++n_;
+}
+
+void GaussianProcess::remove(std::size_t index)
+{
+    if(index >= n_) {
+        return;
+    }
+
+    // the column below the removed diagonal element becomes a rank-one update of the trailing block
+    std::size_t m = n_ - index - 1;
+    for(std::size_t j = 0; j < m; ++j) {
+        tmp_[j] = L(index + 1 + j, index);
+    }
+
+    for(std::size_t row = index + 1; row < n_; ++row) {
+        for(std::size_t col = 0; col < index; ++col) {
+            L(row - 1, col) = L(row, col);
+        }
+        for(std::size_t col = index + 1; col <= row; ++col) {
+            L(row - 1, col - 1) = L(row, col);
+        }
+    }
+
+    for(std::size_t k = 0; k < m; ++k) {
+        double& lkk = L(index + k, index + k);
+        double r = std::sqrt(lkk * lkk + tmp_[k] * tmp_[k]);
+        double c = r / lkk;
+        double s = tmp_[k] / lkk;
+        lkk = r;
+
+        for(std::size_t i = k + 1; i < m; ++i) {
+            double& lik = L(index + i, index + k);
+            lik = (lik + s * tmp_[i]) / c;
+            tmp_[i] = c * tmp_[i] - s * lik;
+        }
+    }
+
+    for(std::size_t i = index + 1; i < n_; ++i) {
+        std::copy(&x_[i * dimension_], &x_[i * dimension_] + dimension_, &x_[(i - 1) * dimension_]);
+        y_[i - 1] = y_[i];
+    }
+    --n_;
+}
+
+void GaussianProcess::truncate(std::size_t size)
+{
+    // the leading block of a Cholesky factor is the factor of the leading block
+    n_ = std::min(n_, size);
+}
+
+std::size_t GaussianProcess::worst() const
+{
+    return std::max_element(y_.begin(), y_.begin() + n_) - y_.begin();
+}
+
+void GaussianProcess::update()
+{
+    if(n_ == 0) {
+        return;
+    }
+
+    double mean = 0.0;
+    for(std::size_t i = 0; i < n_; ++i) {
+        mean += y_[i];
+    }
+    mean /= n_;
+
+    double var = 0.0;
+    for(std::size_t i = 0; i < n_; ++i) {
+        var += (y_[i] - mean) * (y_[i] - mean);
+    }
+    var /= n_;
+
+    y_mean_ = mean;
+    y_scale_ = var > 0.0 ? std::sqrt(var) : 1.0;
+
+    for(std::size_t i = 0; i < n_; ++i) {
+        alpha_[i] = (y_[i] - y_mean_) / y_scale_;
+    }
+    solveLower(alpha_, n_);
+    solveUpper(alpha_, n_);
+}
+
+void GaussianProcess::predict(const double* x, double& mean, double& variance)
+{
+    if(n_ == 0) {
+        mean = y_mean_;
+        variance = y_scale_ * y_scale_;
+        return;
+    }
+
+    double mu = 0.0;
+    for(std::size_t i = 0; i < n_; ++i) {
+        k_[i] = kernel(&x_[i * dimension_], x);
+        mu += k_[i] * alpha_[i];
+    }
+
+    solveLower(k_, n_);
+    double sq = 0.0;
+    for(std::size_t i = 0; i < n_; ++i) {
+        sq += k_[i] * k_[i];
+    }
+
+    mean = y_mean_ + y_scale_ * mu;
+    variance = y_scale_ * y_scale_ * std::max(1.0 - sq, 1e-12);
+}
+
+double GaussianProcess::bestObservation() const
+{
+    if(n_ == 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return *std::min_element(y_.begin(), y_.begin() + n_);
+}
+
+double GaussianProcess::worstObservation() const
+{
+    if(n_ == 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return *std::max_element(y_.begin(), y_.begin() + n_);
+}
+
+double GaussianProcess::kernel(const double* a, const double* b) const
+{
+    double d2 = 0.0;
+    for(std::size_t i = 0; i < dimension_; ++i) {
+        double d = a[i] - b[i];
+        d2 += d * d;
+    }
+    return std::exp(-0.5 * d2 * inv_length_scale_sq_);
+}
+
+double& GaussianProcess::L(std::size_t row, std::size_t col)
+{
+    return chol_[row * capacity_ + col];
+}
+
+double GaussianProcess::L(std::size_t row, std::size_t col) const
+{
+    return chol_[row * capacity_ + col];
+}
+
+void GaussianProcess::solveLower(std::vector<double>& v, std::size_t n) const
+{
+    for(std::size_t i = 0; i < n; ++i) {
+        double sum = v[i];
+        for(std::size_t j = 0; j < i; ++j) {
+            sum -= L(i, j) * v[j];
+        }
+        v[i] = sum / L(i, i);
+    }
+}
+
+void GaussianProcess::solveUpper(std::vector<double>& v, std::size_t n) const
+{
+    for(std::size_t i = n; i-- > 0;) {
+        double sum = v[i];
+        for(std::size_t j = i + 1; j < n; ++j) {
+            sum -= L(j, i) * v[j];
+        }
+        v[i] = sum / L(i, i);
+    }
+}
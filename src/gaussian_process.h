@@ -0,0 +1,71 @@
+#ifndef GAUSSIAN_PROCESS_H
+#define GAUSSIAN_PROCESS_H
+
+#include <vector>
+
+namespace csapex
+{
+
+/**
+ * @brief The GaussianProcess class is a GP regression model with a bounded number of observations.
+ *
+ * The Cholesky factor of the kernel matrix is extended row by row when an observation is added
+ * and repaired with a rank-one update when one is removed, so neither operation refactors the
+ * whole matrix. Inputs are expected to be normalized to the unit cube, outputs are standardized
+ * internally. The kernel is a squared exponential with a shared length scale.
+ */
+class GaussianProcess
+{
+public:
+    GaussianProcess();
+
+    void configure(std::size_t dimension, std::size_t capacity, double length_scale, double noise);
+    void clear();
+
+    std::size_t size() const;
+    std::size_t capacity() const;
+
+    void add(const double* x, double y);
+    void remove(std::size_t index);
+    void truncate(std::size_t size);
+
+    std::size_t worst() const;
+
+    void update();
+    void predict(const double* x, double& mean, double& variance);
+
+    double bestObservation() const;
+    double worstObservation() const;
+
+private:
+    double kernel(const double* a, const double* b) const;
+
+    double& L(std::size_t row, std::size_t col);
+    double L(std::size_t row, std::size_t col) const;
+
+    void solveLower(std::vector<double>& v, std::size_t n) const;
+    void solveUpper(std::vector<double>& v, std::size_t n) const;
+
+private:
+    std::size_t dimension_;
+    std::size_t capacity_;
+    double inv_length_scale_sq_;
+    double noise_;
+
+    std::size_t n_;
+    std::vector<double> x_;
+    std::vector<double> y_;
+
+    std::vector<double> chol_;
+
+    double y_mean_;
+    double y_scale_;
+    std::vector<double> alpha_;
+
+    std::vector<double> k_;
+    std::vector<double> tmp_;
+};
+
+}
+
+#endif // GAUSSIAN_PROCESS_H
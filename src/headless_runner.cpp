@@ -0,0 +1,206 @@
+/// COMPONENT
+#include "eva_optimizer.h"
+
+/// PROJECT
+#include <csapex/core/csapex_core.h>
+#include <csapex/core/exception_handler.h>
+#include <csapex/core/settings/settings_impl.h>
+#include <csapex/model/graph_facade_impl.h>
+#include <csapex/model/graph/graph_impl.h>
+#include <csapex/model/node_facade_impl.h>
+#include <csapex/param/parameter.h>
+
+/// SYSTEM
+#include <yaml-cpp/yaml.h>
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace csapex;
+
+namespace {
+
+void usage(const char* program)
+{
+    std::cerr << "usage: " << program << " --graph <file.apex> [options]\n"
+              << "  --node <label>       label of the EvA2 optimizer node (default: first one found)\n"
+              << "  --method <name>      optimization method: DE, GA, PSO, BO, SSDE or Portfolio\n"
+              << "  --options <file>     YAML map of optimizer parameter names to values\n"
+              << "  --set <name>=<value> set a single optimizer parameter, may be repeated\n"
+              << "  --output <dir>       directory for the results (default: .)\n"
+              << "  --timeout <seconds>  abort the run after the given time (default: none)\n";
+}
+
+void applyValue(const param::ParameterPtr& p, const YAML::Node& value)
+{
+    if(p->is<int>()) {
+        p->set<int>(value.as<int>());
+    } else if(p->is<double>()) {
+        p->set<double>(value.as<double>());
+    } else if(p->is<bool>()) {
+        p->set<bool>(value.as<bool>());
+    } else if(p->is<std::string>()) {
+        p->set<std::string>(value.as<std::string>());
+    } else if(p->is<std::pair<int, int>>()) {
+        p->set<std::pair<int, int>>(std::make_pair(value[0].as<int>(), value[1].as<int>()));
+    } else if(p->is<std::pair<double, double>>()) {
+        p->set<std::pair<double, double>>(std::make_pair(value[0].as<double>(), value[1].as<double>()));
+    } else {
+        throw std::runtime_error(std::string("cannot set parameter ") + p->name() + " from the command line");
+    }
+}
+
+void applyOption(EvaOptimizer& node, const std::string& name, const YAML::Node& value)
+{
+    if(!node.hasParameter(name)) {
+        throw std::runtime_error(std::string("unknown parameter ") + name);
+    }
+    applyValue(node.getParameter(name), value);
+}
+
+std::shared_ptr<EvaOptimizer> findOptimizer(const GraphFacadeImplementationPtr& root, const std::string& label)
+{
+    for(const UUID& uuid : root->getLocalGraph()->getAllNodeUUIDs()) {
+        NodeFacadeImplementationPtr nf = std::dynamic_pointer_cast<NodeFacadeImplementation>(root->findNodeFacade(uuid));
+        if(!nf) {
+            continue;
+        }
+        std::shared_ptr<EvaOptimizer> optimizer = std::dynamic_pointer_cast<EvaOptimizer>(nf->getNode());
+        if(optimizer && (label.empty() || nf->getLabel() == label)) {
+            return optimizer;
+        }
+    }
+    return nullptr;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    std::string graph_file;
+    std::string node_label;
+    std::string method;
+    std::string options_file;
+    std::vector<std::string> assignments;
+    std::string output_dir = ".";
+    double timeout = -1.0;
+
+    for(int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if(arg == "--help" || arg == "-h") {
+            usage(argv[0]);
+            return 0;
+        } else if(arg == "--graph" && has_value) {
+            graph_file = argv[++i];
+        } else if(arg == "--node" && has_value) {
+            node_label = argv[++i];
+        } else if(arg == "--method" && has_value) {
+            method = argv[++i];
+        } else if(arg == "--options" && has_value) {
+            options_file = argv[++i];
+        } else if(arg == "--set" && has_value) {
+            assignments.push_back(argv[++i]);
+        } else if(arg == "--output" && has_value) {
+            output_dir = argv[++i];
+        } else if(arg == "--timeout" && has_value) {
+            timeout = std::stod(argv[++i]);
+        } else {
+            std::cerr << "unknown argument: " << arg << std::endl;
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if(graph_file.empty()) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    SettingsImplementation settings;
+
+    ExceptionHandler handler(false);
+    CsApexCorePtr core = std::make_shared<CsApexCore>(settings, handler);
+
+    bool success = false;
+    std::thread main_loop;
+    bool shut_down = false;
+
+    auto shutdown = [&]() {
+        if(!shut_down) {
+            core->shutdown();
+            shut_down = true;
+        }
+        if(main_loop.joinable()) {
+            main_loop.join();
+        }
+    };
+
+    try {
+        core->init();
+        core->load(graph_file);
+
+        std::shared_ptr<EvaOptimizer> optimizer = findOptimizer(core->getRoot(), node_label);
+        if(!optimizer) {
+            throw std::runtime_error("no EvA2 optimizer node found in " + graph_file);
+        }
+
+        if(!method.empty() && !optimizer->setMethod(method)) {
+            throw std::runtime_error("unknown method " + method);
+        }
+
+        if(!options_file.empty()) {
+            YAML::Node options = YAML::LoadFile(options_file);
+            for(YAML::const_iterator it = options.begin(); it != options.end(); ++it) {
+                applyOption(*optimizer, it->first.as<std::string>(), it->second);
+            }
+        }
+
+        for(const std::string& assignment : assignments) {
+            std::size_t eq = assignment.find('=');
+            if(eq == std::string::npos) {
+                throw std::runtime_error("expected <name>=<value>, got " + assignment);
+            }
+            applyOption(*optimizer, assignment.substr(0, eq), YAML::Load(assignment.substr(eq + 1)));
+        }
+
+        main_loop = std::thread([core]() {
+            core->startMainLoop();
+        });
+
+        // the run starts in the node's own thread, the main loop drives it from there
+        optimizer->startOptimization();
+
+        auto start = std::chrono::steady_clock::now();
+        while(!optimizer->hasFinished() && !optimizer->hasFailed()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if(timeout > 0 && elapsed.count() > timeout) {
+                std::cerr << "optimization timed out after " << elapsed.count() << "s" << std::endl;
+                break;
+            }
+        }
+
+        success = optimizer->hasFinished() && !optimizer->hasFailed();
+
+        // the node must not run anymore while the results are written
+        shutdown();
+
+        // a run that timed out or failed still holds the candidate that was evaluated last
+        optimizer->abortOptimization();
+
+        boost::filesystem::create_directories(output_dir);
+        optimizer->writeResults(output_dir);
+
+    } catch(const std::exception& e) {
+        std::cerr << "optimization failed: " << e.what() << std::endl;
+        success = false;
+    }
+
+    shutdown();
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+#include "local_search.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace csapex;
+
+namespace {
+double minimalStep(double min, double max, double grid)
+{
+    return grid > 0.0 ? grid : (max - min) * 1e-3;
+}
+
+double quantizeStep(double step, double min_step, double grid)
+{
+    if(grid > 0.0) {
+        step = std::round(step / grid) * grid;
+    }
+    return std::max(step, min_step);
+}
+}
+
+LocalSearch::LocalSearch()
+    : f_(0.0), dim_(0), sign_(1), improved_(false), budget_(0), evaluations_(0), running_(false)
+{
+
+}
+
+void LocalSearch::start(const ParameterLayout& layout, const std::vector<double>& x0, double f0, int budget)
+{
+    std::size_t n = layout.size();
+
+    min_.resize(n);
+    max_.resize(n);
+    grid_.resize(n);
+    step_.resize(n);
+
+    for(std::size_t d = 0; d < n; ++d) {
+        const ParameterLayout::Slot& slot = layout[d];
+        min_[d] = slot.min;
+        max_[d] = slot.max;
+        grid_[d] = slot.step;
+
+        double min_step = minimalStep(slot.min, slot.max, slot.step);
+        step_[d] = quantizeStep(0.25 * (slot.max - slot.min), min_step, slot.step);
+    }
+
+    x_ = x0;
+    f_ = f0;
+    trial_ = x0;
+
+    dim_ = 0;
+    sign_ = 1;
+    improved_ = false;
+
+    budget_ = budget;
+    evaluations_ = 0;
+    running_ = n > 0 && budget > 0;
+}
+
+void LocalSearch::stop()
+{
+    running_ = false;
+}
+
+bool LocalSearch::isRunning() const
+{
+    return running_;
+}
+
+bool LocalSearch::ask(std::vector<double>& x)
+{
+    if(!running_ || evaluations_ >= budget_) {
+        running_ = false;
+        return false;
+    }
+
+    std::size_t n = x_.size();
+    while(true) {
+        if(dim_ == n) {
+            dim_ = 0;
+            if(!improved_ && !shrink()) {
+                // converged at the resolution of the parameters
+                running_ = false;
+                return false;
+            }
+            improved_ = false;
+        }
+
+        double candidate = snap(dim_, x_[dim_] + sign_ * step_[dim_]);
+        if(candidate != x_[dim_]) {
+            trial_ = x_;
+            trial_[dim_] = candidate;
+            x = trial_;
+            return true;
+        }
+
+        nextDirection();
+    }
+}
+
+void LocalSearch::tell(double fitness)
+{
+    ++evaluations_;
+
+    if(fitness < f_) {
+        // keep moving in the successful direction
+        x_ = trial_;
+        f_ = fitness;
+        improved_ = true;
+
+    } else {
+        nextDirection();
+    }
+}
+
+const std::vector<double>& LocalSearch::best() const
+{
+    return x_;
+}
+
+double LocalSearch::bestFitness() const
+{
+    return f_;
+}
+
+int LocalSearch::evaluations() const
+{
+    return evaluations_;
+}
+
+double LocalSearch::snap(std::size_t d, double value) const
+{
+    value = std::max(min_[d], std::min(max_[d], value));
+    if(grid_[d] > 0.0) {
+        value = min_[d] + std::round((value - min_[d]) / grid_[d]) * grid_[d];
+        if(value > max_[d]) {
+            value -= grid_[d];
+        }
+    }
+    return value;
+}
+
+void LocalSearch::nextDirection()
+{
+    if(sign_ > 0) {
+        sign_ = -1;
+    } else {
+        sign_ = 1;
+        ++dim_;
+    }
+}
+
+bool LocalSearch::shrink()
+{
+    bool shrunk = false;
+    for(std::size_t d = 0; d < step_.size(); ++d) {
+        double min_step = minimalStep(min_[d], max_[d], grid_[d]);
+        if(step_[d] > min_step) {
+            step_[d] = quantizeStep(0.5 * step_[d], min_step, grid_[d]);
+            shrunk = true;
+        }
+    }
+    return shrunk;
+}
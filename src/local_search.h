@@ -0,0 +1,63 @@
+#ifndef LOCAL_SEARCH_H
+#define LOCAL_SEARCH_H
+
+#include "parameter_layout.h"
+
+#include <vector>
+
+namespace csapex
+{
+
+/**
+ * @brief The LocalSearch class refines a single candidate with a compass pattern search.
+ *
+ * Each dimension is probed in both directions with its own step size. The step sizes are
+ * multiples of the parameter step, so integer parameters are never probed in between.
+ * When a full sweep brings no improvement, the steps are halved until they reach the
+ * parameter step. Lower fitness values are better.
+ */
+class LocalSearch
+{
+public:
+    LocalSearch();
+
+    void start(const ParameterLayout& layout, const std::vector<double>& x0, double f0, int budget);
+    void stop();
+
+    bool isRunning() const;
+
+    bool ask(std::vector<double>& x);
+    void tell(double fitness);
+
+    const std::vector<double>& best() const;
+    double bestFitness() const;
+    int evaluations() const;
+
+private:
+    double snap(std::size_t d, double value) const;
+    void nextDirection();
+    bool shrink();
+
+private:
+    std::vector<double> min_;
+    std::vector<double> max_;
+    std::vector<double> grid_;
+
+    std::vector<double> x_;
+    double f_;
+
+    std::vector<double> step_;
+    std::vector<double> trial_;
+
+    std::size_t dim_;
+    int sign_;
+    bool improved_;
+
+    int budget_;
+    int evaluations_;
+    bool running_;
+};
+
+}
+
+#endif // LOCAL_SEARCH_H
@@ -0,0 +1,44 @@
+#include "native_optimizer.h"
+
+using namespace csapex;
+
+NativeOptimizer::NativeOptimizer()
+{
+
+}
+
+void NativeOptimizer::encodeParameters(const std::vector<param::ParameterPtr>& params, YAML::Node& out)
+{
+    layout_.build(params);
+
+    out["problem_dimension"] = layout_.size();
+}
+
+void NativeOptimizer::decodeParameters(const cslibs_jcppsocket::SocketMsg::Ptr& /*msg*/,
+                                       const std::vector<param::ParameterPtr>& /*params*/)
+{
+    throw std::runtime_error(getName() + " does not use the EvA2 server");
+}
+
+const ParameterLayout& NativeOptimizer::getLayout() const
+{
+    return layout_;
+}
+
+void NativeOptimizer::normalize(const std::vector<double>& values, double* u) const
+{
+    for(std::size_t d = 0, n = layout_.size(); d < n; ++d) {
+        const ParameterLayout::Slot& slot = layout_[d];
+        double range = slot.max - slot.min;
+        u[d] = range > 0.0 ? (values[d] - slot.min) / range : 0.0;
+    }
+}
+
+void NativeOptimizer::denormalize(const double* u, std::vector<double>& values) const
+{
+    values.resize(layout_.size());
+    for(std::size_t d = 0, n = layout_.size(); d < n; ++d) {
+        const ParameterLayout::Slot& slot = layout_[d];
+        values[d] = slot.min + u[d] * (slot.max - slot.min);
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef NATIVE_OPTIMIZER_H
+#define NATIVE_OPTIMIZER_H
+
+#include "abstract_optimizer.h"
+#include "parameter_layout.h"
+
+namespace csapex
+{
+
+/**
+ * @brief The NativeOptimizer class is the base for optimizers that run inside the node.
+ *
+ * Native optimizers do not talk to the EvA2 server. The node asks them for the next
+ * candidate and tells them the fitness of the evaluated one.
+ */
+class NativeOptimizer : public AbstractOptimizer
+{
+public:
+    NativeOptimizer();
+
+    void encodeParameters(const std::vector<param::ParameterPtr>& params,
+                          YAML::Node& out) override;
+
+    void decodeParameters(const cslibs_jcppsocket::SocketMsg::Ptr& msg,
+                          const std::vector<param::ParameterPtr> &params) override;
+
+    const ParameterLayout& getLayout() const;
+
+    /**
+     * @brief ask generates the next candidate in parameter space
+     * @return false, if the optimization is done
+     */
+    virtual bool ask(std::vector<double>& values) = 0;
+
+    /**
+     * @brief tell reports the fitness of a candidate, failed candidates report infinity instead of the penalty
+     */
+    virtual void tell(const std::vector<double>& values, double fitness) = 0;
+
+    /**
+     * @brief setEvaluationBudget overrides the budget parameter, used when the optimizer runs inside a portfolio
+     */
+    virtual void setEvaluationBudget(int budget) = 0;
+
+protected:
+    // maps between parameter values and the unit cube spanned by the layout
+    void normalize(const std::vector<double>& values, double* u) const;
+    void denormalize(const double* u, std::vector<double>& values) const;
+
+protected:
+    ParameterLayout layout_;
+};
+
+}
+
+#endif // NATIVE_OPTIMIZER_H
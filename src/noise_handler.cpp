@@ -0,0 +1,157 @@
+#include "noise_handler.h"
+
+#include <cmath>
+
+using namespace csapex;
+
+NoiseHandler::NoiseHandler()
+    : mode_(Mode::Off), max_samples_(1), z_(1.96), tolerance_(0.05),
+      n_(0), mean_(0.0), m2_(0.0),
+      pooled_m2_(0.0), pooled_dof_(0),
+      has_incumbent_(false), incumbent_n_(0), incumbent_mean_(0.0), incumbent_variance_(0.0)
+{
+
+}
+
+void NoiseHandler::configure(Mode mode, int max_samples, double z, double tolerance)
+{
+    mode_ = mode;
+    max_samples_ = max_samples;
+    z_ = z;
+    tolerance_ = tolerance;
+}
+
+void NoiseHandler::setParameters(const std::vector<param::ParameterPtr>& params)
+{
+    if(!layout_.matches(params)) {
+        layout_.build(params);
+    }
+}
+
+void NoiseHandler::reset()
+{
+    pooled_m2_ = 0.0;
+    pooled_dof_ = 0;
+    has_incumbent_ = false;
+
+    begin();
+}
+
+bool NoiseHandler::isEnabled() const
+{
+    return mode_ != Mode::Off && max_samples_ > 1;
+}
+
+void NoiseHandler::begin()
+{
+    n_ = 0;
+    mean_ = 0.0;
+    m2_ = 0.0;
+}
+
+void NoiseHandler::addSample(double fitness)
+{
+    ++n_;
+    double delta = fitness - mean_;
+    mean_ += delta / n_;
+    m2_ += delta * (fitness - mean_);
+}
+
+bool NoiseHandler::needsMoreSamples() const
+{
+    if(!isEnabled() || n_ >= max_samples_ || !std::isfinite(mean_)) {
+        return false;
+    }
+
+    bool noise_known = pooled_dof_ > 0 || n_ >= 2;
+    double half_width = z_ * std::sqrt(variance() / n_);
+
+    if(!has_incumbent_) {
+        // the first candidate establishes the noise level
+        return !noise_known;
+    }
+
+    double incumbent_half_width = z_ * std::sqrt(incumbent_variance_ / incumbent_n_);
+    if(mean_ - half_width > incumbent_mean_ + incumbent_half_width) {
+        // clearly worse, more samples would not change the ranking
+        return false;
+    }
+
+    if(!noise_known) {
+        return true;
+    }
+
+    switch(mode_) {
+    case Mode::Racing:
+        // keep sampling while candidate and incumbent cannot be told apart
+        return mean_ + half_width >= incumbent_mean_ - incumbent_half_width;
+
+    case Mode::ConfidenceInterval:
+        return half_width > tolerance_ * std::max(std::abs(mean_), 1e-12);
+
+    default:
+        return false;
+    }
+}
+
+void NoiseHandler::accept()
+{
+    if(n_ == 0) {
+        return;
+    }
+
+    if(n_ >= 2) {
+        pooled_m2_ += m2_;
+        pooled_dof_ += n_ - 1;
+    }
+
+    if(!has_incumbent_ || mean_ < incumbent_mean_) {
+        has_incumbent_ = true;
+        incumbent_n_ = n_;
+        incumbent_mean_ = mean_;
+        incumbent_variance_ = variance();
+        layout_.read(incumbent_);
+    }
+}
+
+int NoiseHandler::samples() const
+{
+    return n_;
+}
+
+double NoiseHandler::mean() const
+{
+    return mean_;
+}
+
+double NoiseHandler::variance() const
+{
+    return n_ >= 2 ? m2_ / (n_ - 1) : noiseVariance();
+}
+
+bool NoiseHandler::hasIncumbent() const
+{
+    return has_incumbent_;
+}
+
+double NoiseHandler::incumbentMean() const
+{
+    return incumbent_mean_;
+}
+
+double NoiseHandler::incumbentVariance() const
+{
+    return incumbent_variance_;
+}
+
+void NoiseHandler::applyIncumbent() const
+{
+    if(has_incumbent_ && !incumbent_.empty()) {
+        layout_.apply(incumbent_.data());
+    }
+}
+
+double NoiseHandler::noiseVariance() const
+{
+    return pooled_dof_ > 0 ? pooled_m2_ / pooled_dof_ : 0.0;
+}
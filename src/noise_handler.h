@@ -0,0 +1,79 @@
+#ifndef NOISE_HANDLER_H
+#define NOISE_HANDLER_H
+
+#include "parameter_layout.h"
+
+#include <vector>
+
+namespace csapex
+{
+
+/**
+ * @brief The NoiseHandler class decides how often a candidate has to be evaluated under noisy fitness.
+ *
+ * Only promising candidates are sampled again: a candidate that is clearly worse than the incumbent
+ * is dropped after one evaluation. In racing mode, sampling stops as soon as the confidence intervals
+ * of candidate and incumbent separate. In confidence interval mode, sampling stops when the interval
+ * of the candidate is narrow enough. Lower fitness values are better.
+ */
+class NoiseHandler
+{
+public:
+    enum class Mode
+    {
+        Off,
+        Racing,
+        ConfidenceInterval
+    };
+
+public:
+    NoiseHandler();
+
+    void configure(Mode mode, int max_samples, double z, double tolerance);
+    void setParameters(const std::vector<param::ParameterPtr>& params);
+    void reset();
+
+    bool isEnabled() const;
+
+    void begin();
+    void addSample(double fitness);
+    bool needsMoreSamples() const;
+    void accept();
+
+    int samples() const;
+    double mean() const;
+    double variance() const;
+
+    bool hasIncumbent() const;
+    double incumbentMean() const;
+    double incumbentVariance() const;
+    void applyIncumbent() const;
+
+private:
+    double noiseVariance() const;
+
+private:
+    Mode mode_;
+    int max_samples_;
+    double z_;
+    double tolerance_;
+
+    ParameterLayout layout_;
+
+    int n_;
+    double mean_;
+    double m2_;
+
+    double pooled_m2_;
+    int pooled_dof_;
+
+    bool has_incumbent_;
+    int incumbent_n_;
+    double incumbent_mean_;
+    double incumbent_variance_;
+    std::vector<double> incumbent_;
+};
+
+}
+
+#endif // NOISE_HANDLER_H
@@ -0,0 +1,192 @@
+#include "optimization_report.h"
+
+#include <csapex/param/parameter.h>
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+using namespace csapex;
+
+namespace {
+double seconds(OptimizationReport::Clock::duration d)
+{
+    return std::chrono::duration<double>(d).count();
+}
+}
+
+OptimizationReport::OptimizationReport()
+    : seed_(0), success_(false), server_request_running_(false), pending_server_time_(0.0), evaluation_running_(false)
+{
+
+}
+
+void OptimizationReport::reset(const std::string& method, std::uint64_t seed)
+{
+    method_ = method;
+    seed_ = seed;
+    success_ = false;
+
+    evaluations_.clear();
+
+    run_start_ = Clock::now();
+    run_end_ = run_start_;
+
+    server_request_running_ = false;
+    pending_server_time_ = 0.0;
+    evaluation_running_ = false;
+}
+
+void OptimizationReport::reserve(std::size_t evaluations)
+{
+    evaluations_.reserve(evaluations);
+}
+
+void OptimizationReport::beginServerRequest()
+{
+    server_start_ = Clock::now();
+    server_request_running_ = true;
+}
+
+void OptimizationReport::endServerRequest()
+{
+    if(server_request_running_) {
+        pending_server_time_ += seconds(Clock::now() - server_start_);
+        server_request_running_ = false;
+    }
+}
+
+void OptimizationReport::beginEvaluation()
+{
+    evaluation_start_ = Clock::now();
+    evaluation_running_ = true;
+}
+
+void OptimizationReport::endEvaluation(int generation, double fitness, double best_fitness)
+{
+    Evaluation e;
+    e.index = evaluations_.size();
+    e.generation = generation;
+    e.fitness = fitness;
+    e.best_fitness = best_fitness;
+    e.evaluation_time = evaluation_running_ ? seconds(Clock::now() - evaluation_start_) : 0.0;
+    e.server_time = pending_server_time_;
+
+    evaluations_.push_back(e);
+
+    pending_server_time_ = 0.0;
+    evaluation_running_ = false;
+}
+
+void OptimizationReport::finish(bool success)
+{
+    success_ = success;
+    run_end_ = Clock::now();
+}
+
+bool OptimizationReport::isSuccess() const
+{
+    return success_;
+}
+
+const std::vector<OptimizationReport::Evaluation>& OptimizationReport::evaluations() const
+{
+    return evaluations_;
+}
+
+void OptimizationReport::writeRunLog(const std::string& path) const
+{
+    std::ofstream out(path);
+    if(!out) {
+        throw std::runtime_error(std::string("cannot write run log to ") + path);
+    }
+
+    // the seed is enough to replay the run
+    if(seed_ != 0) {
+        out << "# seed: " << seed_ << "\n";
+    }
+    out << "index,generation,fitness,best_fitness,evaluation_time,server_time\n";
+    for(const Evaluation& e : evaluations_) {
+        out << e.index << ',' << e.generation << ',' << e.fitness << ',' << e.best_fitness << ','
+            << e.evaluation_time << ',' << e.server_time << '\n';
+    }
+}
+
+void OptimizationReport::writeTiming(const std::string& path) const
+{
+    double eval_sum = 0.0;
+    double eval_min = std::numeric_limits<double>::infinity();
+    double eval_max = 0.0;
+    double server_sum = 0.0;
+
+    for(const Evaluation& e : evaluations_) {
+        eval_sum += e.evaluation_time;
+        eval_min = std::min(eval_min, e.evaluation_time);
+        eval_max = std::max(eval_max, e.evaluation_time);
+        server_sum += e.server_time;
+    }
+
+    std::size_t n = evaluations_.size();
+
+    YAML::Node timing;
+    timing["method"] = method_;
+    if(seed_ != 0) {
+        timing["seed"] = seed_;
+    }
+    timing["success"] = success_;
+    timing["evaluations"] = n;
+    timing["total_time"] = seconds(run_end_ - run_start_);
+    timing["evaluation_time/total"] = eval_sum;
+    timing["evaluation_time/mean"] = n > 0 ? eval_sum / n : 0.0;
+    timing["evaluation_time/min"] = n > 0 ? eval_min : 0.0;
+    timing["evaluation_time/max"] = eval_max;
+    timing["server_time/total"] = server_sum;
+    timing["server_time/mean"] = n > 0 ? server_sum / n : 0.0;
+
+    std::ofstream out(path);
+    if(!out) {
+        throw std::runtime_error(std::string("cannot write timing statistics to ") + path);
+    }
+    out << timing << '\n';
+}
+
+void OptimizationReport::writeParameters(const std::vector<param::ParameterPtr>& params, const std::string& path) const
+{
+    YAML::Node best;
+    for(const param::ParameterPtr& p : params) {
+        if(p->is<int>()) {
+            best[p->name()] = p->as<int>();
+        } else if(p->is<double>()) {
+            best[p->name()] = p->as<double>();
+        } else if(p->is<bool>()) {
+            best[p->name()] = p->as<bool>();
+        } else if(p->is<std::string>()) {
+            best[p->name()] = p->as<std::string>();
+        } else if(p->is<std::pair<int, int>>()) {
+            std::pair<int, int> v = p->as<std::pair<int, int>>();
+            best[p->name()].push_back(v.first);
+            best[p->name()].push_back(v.second);
+        } else if(p->is<std::pair<double, double>>()) {
+            std::pair<double, double> v = p->as<std::pair<double, double>>();
+            best[p->name()].push_back(v.first);
+            best[p->name()].push_back(v.second);
+        }
+    }
+
+    std::ofstream out(path);
+    if(!out) {
+        throw std::runtime_error(std::string("cannot write parameters to ") + path);
+    }
+    out << best << '\n';
+}
+
+void OptimizationReport::writeStatistics(const YAML::Node& statistics, const std::string& path) const
+{
+    std::ofstream out(path);
+    if(!out) {
+        throw std::runtime_error(std::string("cannot write optimizer statistics to ") + path);
+    }
+    out << statistics << '\n';
+}
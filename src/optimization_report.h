@@ -0,0 +1,89 @@
+#ifndef OPTIMIZATION_REPORT_H
+#define OPTIMIZATION_REPORT_H
+
+#include <csapex/param/param_fwd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace YAML
+{
+class Node;
+}
+
+namespace csapex
+{
+
+/**
+ * @brief The OptimizationReport class collects the run log and timing statistics of one run.
+ *
+ * It does not depend on any GUI code, so that headless runners can write the results of a run.
+ */
+class OptimizationReport
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Evaluation
+    {
+        int index;
+        int generation;
+        double fitness;
+        double best_fitness;
+
+        double evaluation_time;
+        double server_time;
+    };
+
+public:
+    OptimizationReport();
+
+    /**
+     * @param seed replays the run, 0 if the method cannot be replayed
+     */
+    void reset(const std::string& method, std::uint64_t seed);
+
+    /**
+     * @brief reserve keeps the run log from growing during the first evaluations of a run
+     */
+    void reserve(std::size_t evaluations);
+
+    void beginServerRequest();
+    void endServerRequest();
+
+    void beginEvaluation();
+    void endEvaluation(int generation, double fitness, double best_fitness);
+
+    void finish(bool success);
+
+    bool isSuccess() const;
+    const std::vector<Evaluation>& evaluations() const;
+
+    void writeRunLog(const std::string& path) const;
+    void writeTiming(const std::string& path) const;
+    void writeParameters(const std::vector<param::ParameterPtr>& params, const std::string& path) const;
+    void writeStatistics(const YAML::Node& statistics, const std::string& path) const;
+
+private:
+    std::string method_;
+    std::uint64_t seed_;
+    bool success_;
+
+    std::vector<Evaluation> evaluations_;
+
+    Clock::time_point run_start_;
+    Clock::time_point run_end_;
+
+    Clock::time_point server_start_;
+    bool server_request_running_;
+    double pending_server_time_;
+
+    Clock::time_point evaluation_start_;
+    bool evaluation_running_;
+};
+
+}
+
+#endif // OPTIMIZATION_REPORT_H
@@ -0,0 +1,282 @@
+#include "optimizer_bo.h"
+
+#include <csapex/param/parameter_factory.h>
+#include <csapex/param/output_progress_parameter.h>
+
+#include <cmath>
+#include <limits>
+
+using namespace csapex;
+
+OptimizerBO::OptimizerBO()
+    : initialized_(false), batch_(0),
+      evaluations_(0), budget_(200), issued_(0),
+      initial_samples_(10), batch_size_(1), acquisition_((int) Acquisition::ExpectedImprovement), kappa_(2.0),
+      max_observations_(300), length_scale_(0.2), candidates_(500),
+      queue_pos_(0), best_fitness_(std::numeric_limits<double>::infinity()), incumbent_(0.0)
+{
+
+}
+
+std::string OptimizerBO::getName() const
+{
+    return "BO";
+}
+
+bool OptimizerBO::canContinue() const
+{
+    return issued_ < budget_;
+}
+
+int OptimizerBO::getEvaluationBudget() const
+{
+    return budget_;
+}
+
+void OptimizerBO::addParameters(Parameterizable& params)
+{
+    AbstractOptimizer::addParameters(params);
+
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("evaluations", 1, 10000, 200, 1), [this](param::Parameter* p) {
+        budget_ = p->as<int>();
+        progress_evaluation_->setProgress(evaluation_, budget_);
+    });
+
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("bo/initial_samples", 1, 200, 10, 1),
+                                 initial_samples_);
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("bo/batch_size", 1, 16, 1, 1),
+                                 batch_size_);
+
+    std::map<std::string, int> acquisitions {
+        {"expected improvement", (int) Acquisition::ExpectedImprovement},
+        {"upper confidence bound", (int) Acquisition::UpperConfidenceBound}
+    };
+    params.addTemporaryParameter(param::ParameterFactory::declareParameterSet("bo/acquisition", acquisitions,
+                                                                              (int) Acquisition::ExpectedImprovement),
+                                 acquisition_);
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("bo/kappa", 0.0, 10.0, 2.0, 0.1),
+                                 kappa_);
+
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("bo/max_observations", 10, 2000, 300, 10),
+                                 max_observations_);
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("bo/length_scale", 0.01, 1.0, 0.2, 0.01),
+                                 length_scale_);
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("bo/candidates", 10, 10000, 500, 10),
+                                 candidates_);
+}
+
+void OptimizerBO::initialize()
+{
+    std::size_t dim = layout_.size();
+
+    // fantasized observations of a batch need room on top of the real ones
+    gp_.configure(dim, max_observations_ + batch_size_, length_scale_, 1e-6);
+
+    queue_.clear();
+    queue_pos_ = 0;
+    batch_ = 0;
+
+    best_u_.assign(dim, 0.0);
+    best_fitness_ = std::numeric_limits<double>::infinity();
+
+    u_.resize(dim);
+    candidate_.resize(dim);
+    choice_.resize(dim);
+
+    initialized_ = true;
+}
+
+bool OptimizerBO::ask(std::vector<double>& values)
+{
+    if(!initialized_) {
+        initialize();
+    }
+
+    if(issued_ >= budget_ || layout_.empty()) {
+        return false;
+    }
+
+    std::size_t dim = layout_.size();
+    if(queue_pos_ >= queue_.size()) {
+        queue_.clear();
+        queue_pos_ = 0;
+
+        if((int) gp_.size() < initial_samples_) {
+            sampleRandomBatch();
+        } else {
+            sampleAcquisitionBatch();
+        }
+    }
+
+    denormalize(&queue_[queue_pos_], values);
+    queue_pos_ += dim;
+
+    ++issued_;
+    return true;
+}
+
+void OptimizerBO::tell(const std::vector<double>& values, double fitness)
+{
+    ++evaluations_;
+
+    addObservation(values, fitness);
+}
+
+void OptimizerBO::setEvaluationBudget(int budget)
+{
+    budget_ = budget;
+}
+
+void OptimizerBO::injectIndividual(const std::vector<double>& values, double fitness)
+{
+    if(!initialized_) {
+        initialize();
+    }
+
+    // a solution found by another optimizer is as informative as an own observation
+    addObservation(values, fitness);
+}
+
+void OptimizerBO::addObservation(const std::vector<double>& values, double fitness)
+{
+    if(!std::isfinite(fitness)) {
+        // failed candidates come without a fitness, a penalty value would wreck the standardization of the model,
+        // the worst observation so far still steers the acquisition away from them
+        if(gp_.size() == 0) {
+            return;
+        }
+        fitness = gp_.worstObservation();
+    }
+
+    normalize(values, u_.data());
+
+    if((int) gp_.size() >= max_observations_) {
+        // keep the model bounded, the worst observation carries the least information about the optimum
+        gp_.remove(gp_.worst());
+    }
+    gp_.add(u_.data(), fitness);
+
+    if(fitness < best_fitness_) {
+        best_fitness_ = fitness;
+        best_u_ = u_;
+    }
+}
+
+void OptimizerBO::sampleRandomBatch()
+{
+    std::size_t dim = layout_.size();
+    for(int b = 0; b < batch_size_; ++b) {
+        // every batch entry has its own stream, the run can be replayed from the seed
+        rng_.seed(seed_, batch_, b);
+        rng_.fillUniform(candidate_.data(), dim);
+
+        snap(candidate_.data());
+        queue_.insert(queue_.end(), candidate_.begin(), candidate_.end());
+    }
+    ++batch_;
+}
+
+void OptimizerBO::sampleAcquisitionBatch()
+{
+    double sigma = 0.25 * length_scale_;
+
+    std::size_t dim = layout_.size();
+    std::size_t observations = gp_.size();
+
+    // half of the candidates explore globally, the other half exploit around the incumbent
+    std::size_t global = (candidates_ + 1) / 2;
+    std::size_t local = candidates_ - global;
+    uniform_.resize(global * dim);
+    normal_.resize(local * dim);
+
+    for(int b = 0; b < batch_size_; ++b) {
+        gp_.update();
+        incumbent_ = gp_.bestObservation();
+
+        rng_.seed(seed_, batch_, b);
+        rng_.fillUniform(uniform_.data(), uniform_.size());
+        rng_.fillNormal(normal_.data(), normal_.size());
+
+        double best_value = -std::numeric_limits<double>::infinity();
+        for(int c = 0; c < candidates_; ++c) {
+            bool explore = c % 2 == 0;
+            const double* sample = explore ? &uniform_[(c / 2) * dim] : &normal_[(c / 2) * dim];
+            for(std::size_t d = 0; d < dim; ++d) {
+                double u = explore ? sample[d] : best_u_[d] + sigma * sample[d];
+                candidate_[d] = std::max(0.0, std::min(1.0, u));
+            }
+            snap(candidate_.data());
+
+            double value = acquisition(candidate_.data());
+            if(value > best_value) {
+                best_value = value;
+                choice_ = candidate_;
+            }
+        }
+
+        queue_.insert(queue_.end(), choice_.begin(), choice_.end());
+
+        if(b + 1 < batch_size_) {
+            // kriging believer: pretend the model is right about the chosen point
+            double mean, variance;
+            gp_.predict(choice_.data(), mean, variance);
+            gp_.add(choice_.data(), mean);
+        }
+    }
+
+    gp_.truncate(observations);
+    gp_.update();
+
+    ++batch_;
+}
+
+double OptimizerBO::acquisition(const double* u)
+{
+    double mean, variance;
+    gp_.predict(u, mean, variance);
+    double sigma = std::sqrt(variance);
+
+    switch(static_cast<Acquisition>(acquisition_)) {
+    case Acquisition::UpperConfidenceBound:
+        // fitness is minimized, so the optimistic bound is the lower one
+        return kappa_ * sigma - mean;
+
+    default:
+    case Acquisition::ExpectedImprovement: {
+        double improvement = incumbent_ - mean;
+        if(sigma <= 0.0) {
+            return std::max(improvement, 0.0);
+        }
+        double z = improvement / sigma;
+        double cdf = 0.5 * std::erfc(-z / std::sqrt(2.0));
+        double pdf = std::exp(-0.5 * z * z) / std::sqrt(2.0 * M_PI);
+        return improvement * cdf + sigma * pdf;
+    }
+    }
+}
+
+void OptimizerBO::snap(double* u) const
+{
+    // int parameters and parameters with a step only take values on their grid
+    for(std::size_t d = 0, n = layout_.size(); d < n; ++d) {
+        const ParameterLayout::Slot& slot = layout_[d];
+        double range = slot.max - slot.min;
+        if(slot.step > 0.0 && range > 0.0) {
+            double steps = std::floor(range / slot.step);
+            u[d] = std::round(u[d] * range / slot.step) * slot.step / range;
+            u[d] = std::min(u[d], steps * slot.step / range);
+        }
+    }
+}
+
+void OptimizerBO::reset()
+{
+    initialized_ = false;
+    gp_.clear();
+
+    evaluations_ = 0;
+    issued_ = 0;
+    individual_ = 0;
+
+    AbstractOptimizer::reset();
+}
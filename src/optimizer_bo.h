@@ -0,0 +1,82 @@
+#ifndef OPTIMIZER_BO_H
+#define OPTIMIZER_BO_H
+
+#include "native_optimizer.h"
+#include "gaussian_process.h"
+#include "philox.h"
+
+namespace csapex
+{
+
+class OptimizerBO : public NativeOptimizer
+{
+    enum class Acquisition
+    {
+        ExpectedImprovement,
+        UpperConfidenceBound
+    };
+
+public:
+    OptimizerBO();
+
+    std::string getName() const override;
+
+    bool canContinue() const override;
+    int getEvaluationBudget() const override;
+
+    void addParameters(Parameterizable& params) override;
+
+    bool ask(std::vector<double>& values) override;
+    void tell(const std::vector<double>& values, double fitness) override;
+    void setEvaluationBudget(int budget) override;
+
+    void injectIndividual(const std::vector<double>& values, double fitness) override;
+
+    void reset() override;
+
+private:
+    void initialize();
+    void addObservation(const std::vector<double>& values, double fitness);
+
+    void sampleRandomBatch();
+    void sampleAcquisitionBatch();
+    double acquisition(const double* u);
+
+    void snap(double* u) const;
+
+private:
+    GaussianProcess gp_;
+    Philox rng_;
+    bool initialized_;
+    unsigned batch_;
+
+    int evaluations_;
+    int budget_;
+    int issued_;
+
+    int initial_samples_;
+    int batch_size_;
+    int acquisition_;
+    double kappa_;
+    int max_observations_;
+    double length_scale_;
+    int candidates_;
+
+    std::vector<double> queue_;
+    std::size_t queue_pos_;
+
+    std::vector<double> best_u_;
+    double best_fitness_;
+    double incumbent_;
+
+    std::vector<double> uniform_;
+    std::vector<double> normal_;
+
+    std::vector<double> u_;
+    std::vector<double> candidate_;
+    std::vector<double> choice_;
+};
+
+}
+
+#endif // OPTIMIZER_BO_H
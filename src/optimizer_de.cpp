@@ -1,7 +1,5 @@
 #include "optimizer_de.h"
 
-#include <csapex/param/range_parameter.h>
-#include <csapex/param/interval_parameter.h>
 #include <csapex/param/parameter_factory.h>
 #include <csapex/param/output_progress_parameter.h>
 
@@ -31,7 +29,7 @@ void OptimizerDE::addParameters(Parameterizable& params)
 {
     AbstractOptimizer::addParameters(params);
 
-    params.addTemporaryParameter(param::ParameterFactory::declareRange("individuals/later_generations", 30, 30, 30, 1),
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("individuals/later_generations", 4, 1000, 30, 1),
                                  individuals_later_);
 
     params.addTemporaryParameter(csapex::param::ParameterFactory::declareRange("generations", -1, 1024, -1, 1), [this](param::Parameter* p) {
@@ -53,6 +51,16 @@ bool OptimizerDE::canContinue() const
     return generations_ == -1 || generation_ < generations_;
 }
 
+int OptimizerDE::getGeneration() const
+{
+    return generation_;
+}
+
+int OptimizerDE::getPopulationSize() const
+{
+    return generation_ > 0 ? individuals_later_ : individuals_;
+}
+
 void OptimizerDE::nextIteration()
 {
     ++generation_;
@@ -73,54 +81,8 @@ void OptimizerDE::terminate()
 
 void OptimizerDE::encodeParameters(const std::vector<param::ParameterPtr>& params, YAML::Node &out)
 {
-    for(csapex::param::Parameter::Ptr p : params) {
-        param::RangeParameter::Ptr range = std::dynamic_pointer_cast<param::RangeParameter>(p);
-        if(range) {
-            if(range->is<double>()) {
-                YAML::Node param_node;
-                param_node["name"] = p->name();
-                param_node["type"] = "double/range";
-                param_node["min"] = range->min<double>();
-                param_node["max"] = range->max<double>();
-                param_node["step"] = range->step<double>();
-
-                out["params"].push_back(param_node);
-                continue;
-
-            } else if(range->is<int>()) {
-                YAML::Node param_node;
-                param_node["name"] = p->name();
-                param_node["type"] = "double/range";
-                param_node["min"] = (double) range->min<int>();
-                param_node["max"] = (double)range->max<int>();
-                param_node["step"] = (double)range->step<int>();
-
-                out["params"].push_back(param_node);
-                continue;
-            }
-        }
-
-        param::IntervalParameter::Ptr interval = std::dynamic_pointer_cast<param::IntervalParameter>(p);
-        if(interval && interval->is<std::pair<int, int>>()) {
-            YAML::Node node_low;
-            node_low["name"] = p->name();
-            node_low["type"] = "double/range";
-            node_low["min"] = (double) interval->min<int>();
-            node_low["max"] = (double) interval->max<int>();
-            node_low["step"] = (double) interval->step<int>();
-
-            YAML::Node node_high;
-            node_high["name"] = p->name();
-            node_high["type"] = "double/range";
-            node_high["min"] = (double) interval->min<int>();
-            node_high["max"] = (double) interval->max<int>();
-            node_high["step"] = (double) interval->step<int>();
-
-            out["params"].push_back(node_low);
-            out["params"].push_back(node_high);
-            continue;
-        }
-    }
+    layout_.build(params);
+    layout_.describe(out);
 }
 
 void OptimizerDE::decodeParameters(const cslibs_jcppsocket::SocketMsg::Ptr &msg,
@@ -134,59 +96,20 @@ void OptimizerDE::decodeParameters(const cslibs_jcppsocket::SocketMsg::Ptr &msg,
 
     current_parameter_set_  = values;
 
-    if(!current_parameter_set_) {
-        return;
+    if(!layout_.matches(params)) {
+        layout_.build(params);
     }
 
-    std::vector<csapex::param::Parameter::Ptr> supported_params;
-
-    for(csapex::param::Parameter::Ptr p : params) {
-        // TODO: support more types
-        param::RangeParameter::Ptr range = std::dynamic_pointer_cast<param::RangeParameter>(p);
-        if(range) {
-            if(range->is<double>()) {
-                supported_params.push_back(p);
-
-            } else if(range->is<int>()) {
-                supported_params.push_back(p);
-            }
-        }
-
-        param::IntervalParameter::Ptr interval = std::dynamic_pointer_cast<param::IntervalParameter>(p);
-        if(interval && interval->is<std::pair<int, int>>()) {
-            supported_params.push_back(p);
-            supported_params.push_back(p);
-        }
-    }
-
-    if(current_parameter_set_->size() != supported_params.size()) {
+    if(current_parameter_set_->size() != layout_.size()) {
         std::stringstream msg;
         msg << "number of parameters is wrong: " << current_parameter_set_->size() <<
-               " vs. " << supported_params.size() << std::endl;
+               " vs. " << layout_.size() << std::endl;
         throw std::runtime_error(msg.str());
     }
 
     // set parameter values to the values specified by eva
-    for(std::size_t i = 0; i < supported_params.size(); ++i) {
-        csapex::param::Parameter::Ptr p = supported_params[i];
-
-        param::IntervalParameter::Ptr interval = std::dynamic_pointer_cast<param::IntervalParameter>(p);
-        if(interval) {
-            auto low = interval;
-            auto high = std::dynamic_pointer_cast<param::IntervalParameter>(supported_params[i]);
-            apex_assert(low);
-            apex_assert(high);
-            p->set<std::pair<int, int>>(std::pair<int, int>
-                                        (current_parameter_set_->at(i), current_parameter_set_->at(i+1)));
-            ++i;
-
-        } else {
-            if(p->is<int>()) {
-                p->set<int>(current_parameter_set_->at(i));
-            } else {
-                p->set<double>(current_parameter_set_->at(i));
-            }
-        }
+    if(!layout_.empty()) {
+        applyFeasible(layout_, &current_parameter_set_->at(0));
     }
 }
 
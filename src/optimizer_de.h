@@ -2,6 +2,7 @@
 #define OPTIMIZER_DE_H
 
 #include "abstract_optimizer.h"
+#include "parameter_layout.h"
 
 namespace csapex
 {
@@ -14,6 +15,8 @@ public:
     std::string getName() const override;
 
     bool canContinue() const override;
+    int getGeneration() const override;
+    int getPopulationSize() const override;
     void nextIteration() override;
     void terminate() override;
 
@@ -31,6 +34,7 @@ public:
 
 private:
     cslibs_jcppsocket::VectorMsg<double>::Ptr current_parameter_set_;
+    ParameterLayout layout_;
 
     int individuals_later_;
 
@@ -3,6 +3,7 @@
 using namespace csapex;
 
 #include "optimizer_de.h"
+#include "constraint_set.h"
 
 #include <csapex/param/range_parameter.h>
 #include <csapex/param/interval_parameter.h>
@@ -14,6 +15,7 @@ using namespace csapex;
 using namespace cslibs_jcppsocket;
 
 OptimizerGA::OptimizerGA()
+    : n_bits_(0)
 {
 
 }
@@ -36,7 +38,7 @@ void OptimizerGA::addParameters(Parameterizable& params)
 {
     AbstractOptimizer::addParameters(params);
 
-    params.addTemporaryParameter(param::ParameterFactory::declareRange("individuals/later_generations", 30, 30, 30, 1),
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("individuals/later_generations", 4, 1000, 30, 1),
                                  individuals_later_);
 
     params.addTemporaryParameter(csapex::param::ParameterFactory::declareRange("generations", -1, 1024, -1, 1), [this](param::Parameter* p) {
@@ -58,12 +60,23 @@ bool OptimizerGA::canContinue() const
     return generations_ == -1 || generation_ < generations_;
 }
 
+int OptimizerGA::getGeneration() const
+{
+    return generation_;
+}
+
+int OptimizerGA::getPopulationSize() const
+{
+    return generation_ > 0 ? individuals_later_ : individuals_;
+}
+
 void OptimizerGA::nextIteration()
 {
+    ++generation_;
+
     if(generations_ == -1) {
         progress_generation_->setProgress(0, 0);
     } else {
-        ++generation_;
         progress_generation_->setProgress(generation_, generations_);
     }
 
@@ -113,10 +126,8 @@ std::size_t getNrOfBits(const csapex::param::Parameter* p)
     return 0;
 }
 
-int readParameterValue(csapex::param::Parameter* p, const char* buffer, int first_bit)
+int readParameterValue(csapex::param::Parameter* p, int len, const char* buffer, int first_bit, ParameterBatch& batch)
 {
-    int len = getNrOfBits(p);
-
     if(auto range = dynamic_cast<param::RangeParameter*>(p)){
         long result = 0;
         for(int b = 0; b < len; ++b) {
@@ -125,7 +136,7 @@ int readParameterValue(csapex::param::Parameter* p, const char* buffer, int firs
 
             bool entry = buffer[byte] & (1 << bit);
             if(entry) {
-                result += std::pow(2, b);
+                result += 1l << b;
             }
         }
 
@@ -141,7 +152,7 @@ int readParameterValue(csapex::param::Parameter* p, const char* buffer, int firs
             apex_assert(value >= min);
             apex_assert(value <= max);
 
-            p->set<double>(value);
+            batch.setDouble(p, value);
         }
         else if(range->is<int>()){
             int min = range->min<int>();
@@ -155,7 +166,7 @@ int readParameterValue(csapex::param::Parameter* p, const char* buffer, int firs
             apex_assert(value >= min);
             apex_assert(value <= max);
 
-            p->set<int>(value);
+            batch.setInt(p, value);
         }
         else {
             throw std::runtime_error(std::string("unsupported parameter type ") + p->type2string(p->type()) );
@@ -167,7 +178,7 @@ int readParameterValue(csapex::param::Parameter* p, const char* buffer, int firs
             std::size_t bit = (first_bit) % 8;
 
             bool entry = buffer[byte] & (1 << bit);
-            p->set<bool>(entry);
+            batch.setBool(p, entry);
         }
         else if(p->is<int>()) {
             int result = 0;
@@ -177,10 +188,10 @@ int readParameterValue(csapex::param::Parameter* p, const char* buffer, int firs
 
                 bool entry = buffer[byte] & (1 << bit);
                 if(entry) {
-                    result += std::pow(2, b);
+                    result += 1 << b;
                 }
             }
-            p->set<int>(result);
+            batch.setInt(p, result);
         }
         else {
             throw std::runtime_error(std::string("unsupported parameter type ") + p->type2string(p->type()) );
@@ -193,38 +204,79 @@ int readParameterValue(csapex::param::Parameter* p, const char* buffer, int firs
 }
 }
 
-void OptimizerGA::encodeParameters(const std::vector<param::ParameterPtr>& params, YAML::Node &out)
+void OptimizerGA::updateLayout(const std::vector<param::ParameterPtr>& params)
+{
+    layout_params_.clear();
+    layout_bits_.clear();
+    n_bits_ = 0;
+
+    for(const csapex::param::Parameter::Ptr& p : params) {
+        std::size_t bits = getNrOfBits(p.get());
+        layout_params_.push_back(p.get());
+        layout_bits_.push_back(bits);
+        n_bits_ += bits;
+    }
+
+    layout_.build(params);
+}
+
+bool OptimizerGA::layoutMatches(const std::vector<param::ParameterPtr>& params) const
 {
-    std::size_t n_bits = 0;
-    for(csapex::param::Parameter::Ptr p : params) {
-        n_bits += getNrOfBits(p.get());
+    if(params.size() != layout_params_.size()) {
+        return false;
+    }
+    for(std::size_t i = 0, n = params.size(); i < n; ++i) {
+        if(params[i].get() != layout_params_[i]) {
+            return false;
+        }
     }
+    return true;
+}
+
+void OptimizerGA::encodeParameters(const std::vector<param::ParameterPtr>& params, YAML::Node &out)
+{
+    updateLayout(params);
 
-    out["problem_dimension"] = n_bits;
+    out["problem_dimension"] = n_bits_;
 }
 
 void OptimizerGA::decodeParameters(const cslibs_jcppsocket::SocketMsg::Ptr &msg,
                                    const std::vector<param::ParameterPtr>& params)
 {
-    std::size_t needed_bits = 0;
-    for(csapex::param::Parameter::Ptr p : params) {
-        needed_bits += getNrOfBits(p.get());
+    if(!layoutMatches(params)) {
+        updateLayout(params);
     }
 
     std::size_t available_bits = msg->byteSize() * 8;
-    apex_assert_msg(available_bits >= needed_bits,
-                    (std::string("not enough bits: ") + std::to_string(available_bits) +
-                    " available, " + std::to_string(needed_bits) + " needed").c_str());
+    if(available_bits < n_bits_) {
+        apex_assert_msg(available_bits >= n_bits_,
+                        (std::string("not enough bits: ") + std::to_string(available_bits) +
+                        " available, " + std::to_string(n_bits_) + " needed").c_str());
+    }
 
-    VectorMsg<char>::Ptr string_message = std::dynamic_pointer_cast<VectorMsg<char> >(msg);
+    VectorMsg<char>* string_message = dynamic_cast<VectorMsg<char>*>(msg.get());
     apex_assert(string_message);
 
     const char* buffer = &*string_message->begin();
 
+    // the individual is decoded completely before any parameter is touched
+    batch_.clear();
+
     std::size_t first_bit = 0;
-    for(csapex::param::Parameter::Ptr p : params) {
-        first_bit += readParameterValue(p.get(), buffer, first_bit);
+    for(std::size_t i = 0, n = layout_params_.size(); i < n; ++i) {
+        first_bit += readParameterValue(layout_params_[i], layout_bits_[i], buffer, first_bit, batch_);
+    }
+
+    // bit strings cannot be repaired, an infeasible individual never reaches the parameters
+    if(constraints_) {
+        layout_.read(batch_, staged_);
+        if(!constraints_->isFeasible(layout_, staged_.data())) {
+            batch_.clear();
+            throw InfeasibleCandidate("candidate violates the constraints");
+        }
     }
+
+    batch_.commit();
 //    std::size_t n_bits = (n_bits / 8 + 1) * 8;
 //    for(csapex::param::Parameter::Ptr p : params) {
 
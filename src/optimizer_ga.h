@@ -2,6 +2,7 @@
 #define OPTIMIZER_GA_H
 
 #include "abstract_optimizer.h"
+#include "parameter_layout.h"
 
 namespace csapex
 {
@@ -13,6 +14,8 @@ public:
     std::string getName() const override;
 
     bool canContinue() const override;
+    int getGeneration() const override;
+    int getPopulationSize() const override;
     void nextIteration() override;
     void terminate() override;
 
@@ -28,9 +31,23 @@ public:
     void reset() override;
     void finish(double fitness, double best_fitness, double worst_fitness) override;
 
+private:
+    void updateLayout(const std::vector<param::ParameterPtr>& params);
+    bool layoutMatches(const std::vector<param::ParameterPtr>& params) const;
+
 private:
     cslibs_jcppsocket::VectorMsg<double>::Ptr current_parameter_set_;
 
+    std::vector<param::Parameter*> layout_params_;
+    std::vector<std::size_t> layout_bits_;
+    std::size_t n_bits_;
+
+    ParameterBatch batch_;
+
+    // the staged individual is checked against the constraints before it is committed
+    ParameterLayout layout_;
+    std::vector<double> staged_;
+
     int individuals_later_;
 
     param::OutputProgressParameter* progress_generation_;
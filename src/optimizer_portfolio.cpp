@@ -0,0 +1,249 @@
+#include "optimizer_portfolio.h"
+#include "optimizer_ssde.h"
+#include "optimizer_bo.h"
+#include "optimizer_pso.h"
+
+#include <csapex/param/parameter_factory.h>
+#include <csapex/param/output_progress_parameter.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace csapex;
+
+OptimizerPortfolio::OptimizerPortfolio()
+    : budget_(1000), issued_(0),
+      exploration_(0.5), discount_(0.95),
+      best_fitness_(std::numeric_limits<double>::infinity())
+{
+    // the engines run with their default settings, their parameters are not exposed
+    addEngine("SSDE", std::make_shared<OptimizerSSDE>());
+    addEngine("BO", std::make_shared<OptimizerBO>());
+    addEngine("PSO", std::make_shared<OptimizerPSO>());
+}
+
+void OptimizerPortfolio::addEngine(const std::string& name, const std::shared_ptr<NativeOptimizer>& optimizer)
+{
+    Engine e;
+    e.name = name;
+    e.optimizer = optimizer;
+    e.enabled = true;
+    e.exhausted = false;
+    e.pulls = 0.0;
+    e.reward = 0.0;
+    e.evaluations = 0;
+    e.improvements = 0;
+    e.best_fitness = std::numeric_limits<double>::infinity();
+
+    engines_.push_back(e);
+}
+
+std::string OptimizerPortfolio::getName() const
+{
+    return "Portfolio";
+}
+
+bool OptimizerPortfolio::canContinue() const
+{
+    return issued_ < budget_;
+}
+
+int OptimizerPortfolio::getEvaluationBudget() const
+{
+    return budget_;
+}
+
+void OptimizerPortfolio::getStatistics(YAML::Node& statistics) const
+{
+    int total = 0;
+    for(const Engine& e : engines_) {
+        total += e.evaluations;
+    }
+
+    for(const Engine& e : engines_) {
+        if(!e.enabled) {
+            continue;
+        }
+
+        YAML::Node engine;
+        engine["evaluations"] = e.evaluations;
+        engine["budget_share"] = total > 0 ? e.evaluations / (double) total : 0.0;
+        engine["improvements"] = e.improvements;
+        if(std::isfinite(e.best_fitness)) {
+            engine["best_fitness"] = e.best_fitness;
+        }
+        e.optimizer->getStatistics(engine);
+        statistics["engines"][e.name] = engine;
+    }
+}
+
+void OptimizerPortfolio::addParameters(Parameterizable& params)
+{
+    AbstractOptimizer::addParameters(params);
+
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("evaluations", 1, 100000, 1000, 1), [this](param::Parameter* p) {
+        budget_ = p->as<int>();
+        progress_evaluation_->setProgress(evaluation_, budget_);
+    });
+
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("portfolio/exploration", 0.0, 5.0, 0.5, 0.01),
+                                 exploration_);
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("portfolio/discount", 0.5, 1.0, 0.95, 0.001),
+                                 discount_);
+
+    for(std::size_t i = 0; i < engines_.size(); ++i) {
+        params.addTemporaryParameter(param::ParameterFactory::declareBool("portfolio/" + engines_[i].name, true),
+                                     [this, i](param::Parameter* p) {
+            engines_[i].enabled = p->as<bool>();
+        });
+    }
+}
+
+void OptimizerPortfolio::encodeParameters(const std::vector<param::ParameterPtr>& params, YAML::Node& out)
+{
+    NativeOptimizer::encodeParameters(params, out);
+
+    for(std::size_t i = 0; i < engines_.size(); ++i) {
+        Engine& e = engines_[i];
+
+        // every engine gets its own seed, derived from the run seed
+        e.optimizer->setSeed(seed_ + 0x9E3779B97F4A7C15ull * (i + 1));
+        e.optimizer->setEvaluationBudget(budget_);
+        e.optimizer->reset();
+
+        YAML::Node engine_out;
+        e.optimizer->encodeParameters(params, engine_out);
+    }
+}
+
+bool OptimizerPortfolio::ask(std::vector<double>& values)
+{
+    while(issued_ < budget_) {
+        int index = selectEngine();
+        if(index < 0) {
+            return false;
+        }
+
+        Engine& e = engines_[index];
+        if(!e.optimizer->ask(values)) {
+            e.exhausted = true;
+            continue;
+        }
+
+        Pending p;
+        if(!free_.empty()) {
+            p = std::move(free_.back());
+            free_.pop_back();
+        }
+        p.values = values;
+        p.engine = index;
+
+        pending_.push_back(std::move(p));
+        ++issued_;
+        return true;
+    }
+
+    return false;
+}
+
+int OptimizerPortfolio::selectEngine() const
+{
+    double total = 0.0;
+    for(const Engine& e : engines_) {
+        if(e.enabled && !e.exhausted) {
+            if(e.pulls <= 0.0) {
+                return &e - &engines_[0];
+            }
+            total += e.pulls;
+        }
+    }
+
+    int best = -1;
+    double best_score = -std::numeric_limits<double>::infinity();
+    for(std::size_t i = 0; i < engines_.size(); ++i) {
+        const Engine& e = engines_[i];
+        if(!e.enabled || e.exhausted) {
+            continue;
+        }
+
+        double score = e.reward / e.pulls + exploration_ * std::sqrt(2.0 * std::log(std::max(total, 1.0)) / e.pulls);
+        if(score > best_score) {
+            best_score = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+void OptimizerPortfolio::tell(const std::vector<double>& values, double fitness)
+{
+    auto pos = std::find_if(pending_.begin(), pending_.end(), [&values](const Pending& p) {
+        return p.values == values;
+    });
+    if(pos == pending_.end()) {
+        return;
+    }
+
+    std::size_t index = pos->engine;
+    free_.push_back(std::move(*pos));
+    pending_.erase(pos);
+
+    Engine& e = engines_[index];
+    e.optimizer->tell(values, fitness);
+
+    ++e.evaluations;
+    if(fitness < e.best_fitness) {
+        e.best_fitness = fitness;
+    }
+
+    bool improved = fitness < best_fitness_;
+
+    // old rewards fade, so the budget follows the engine that improves right now
+    for(Engine& other : engines_) {
+        other.pulls *= discount_;
+        other.reward *= discount_;
+    }
+    e.pulls += 1.0;
+    e.reward += improved ? 1.0 : 0.0;
+
+    if(improved) {
+        best_fitness_ = fitness;
+        ++e.improvements;
+
+        for(std::size_t i = 0; i < engines_.size(); ++i) {
+            if(i != index && engines_[i].enabled) {
+                engines_[i].optimizer->injectIndividual(values, fitness);
+            }
+        }
+    }
+}
+
+void OptimizerPortfolio::setEvaluationBudget(int budget)
+{
+    budget_ = budget;
+}
+
+void OptimizerPortfolio::reset()
+{
+    for(Engine& e : engines_) {
+        e.optimizer->reset();
+        e.exhausted = false;
+        e.pulls = 0.0;
+        e.reward = 0.0;
+        e.evaluations = 0;
+        e.improvements = 0;
+        e.best_fitness = std::numeric_limits<double>::infinity();
+    }
+
+    for(Pending& p : pending_) {
+        free_.push_back(std::move(p));
+    }
+    pending_.clear();
+
+    issued_ = 0;
+    individual_ = 0;
+    best_fitness_ = std::numeric_limits<double>::infinity();
+
+    AbstractOptimizer::reset();
+}
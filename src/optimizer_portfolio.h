@@ -0,0 +1,84 @@
+#ifndef OPTIMIZER_PORTFOLIO_H
+#define OPTIMIZER_PORTFOLIO_H
+
+#include "native_optimizer.h"
+
+#include <memory>
+
+namespace csapex
+{
+
+/**
+ * @brief The OptimizerPortfolio class races several native optimizers on a shared evaluation budget.
+ *
+ * The next candidate is taken from the engine with the best discounted upper confidence bound,
+ * where an engine is rewarded for every evaluation that improves the best fitness of the portfolio.
+ * Discounting lets the budget move to another engine when the current one stops improving.
+ * Every new best solution is injected into all other engines.
+ */
+class OptimizerPortfolio : public NativeOptimizer
+{
+    struct Engine
+    {
+        std::string name;
+        std::shared_ptr<NativeOptimizer> optimizer;
+        bool enabled;
+        bool exhausted;
+
+        // discounted statistics for the bandit
+        double pulls;
+        double reward;
+
+        int evaluations;
+        int improvements;
+        double best_fitness;
+    };
+
+    struct Pending
+    {
+        std::vector<double> values;
+        std::size_t engine;
+    };
+
+public:
+    OptimizerPortfolio();
+
+    std::string getName() const override;
+
+    bool canContinue() const override;
+    int getEvaluationBudget() const override;
+
+    void getStatistics(YAML::Node& statistics) const override;
+    void addParameters(Parameterizable& params) override;
+
+    void encodeParameters(const std::vector<param::ParameterPtr>& params,
+                          YAML::Node& out) override;
+
+    bool ask(std::vector<double>& values) override;
+    void tell(const std::vector<double>& values, double fitness) override;
+    void setEvaluationBudget(int budget) override;
+
+    void reset() override;
+
+private:
+    void addEngine(const std::string& name, const std::shared_ptr<NativeOptimizer>& optimizer);
+    int selectEngine() const;
+
+private:
+    std::vector<Engine> engines_;
+    // finished slots keep their buffers for the next candidates
+    std::vector<Pending> pending_;
+    std::vector<Pending> free_;
+
+    int budget_;
+    int issued_;
+
+    double exploration_;
+    double discount_;
+
+    double best_fitness_;
+};
+
+}
+
+#endif // OPTIMIZER_PORTFOLIO_H
@@ -0,0 +1,293 @@
+#include "optimizer_pso.h"
+
+#include <csapex/param/parameter_factory.h>
+#include <csapex/param/output_progress_parameter.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace csapex;
+
+namespace {
+// a swarm smaller than this has no neighborhood to speak of
+const int MIN_SWARM = 2;
+}
+
+OptimizerPSO::OptimizerPSO()
+    : initialized_(false),
+      budget_(1000), issued_(0),
+      topology_((int) Topology::Grid), topology_range_(2), inertia_(0.73), phi1_(2.05), phi2_(2.05),
+      progress_generation_(nullptr), swarm_size_(0)
+{
+
+}
+
+std::string OptimizerPSO::getName() const
+{
+    return "PSO";
+}
+
+bool OptimizerPSO::canContinue() const
+{
+    return issued_ < budget_;
+}
+
+int OptimizerPSO::getGeneration() const
+{
+    // one generation is one move of the whole swarm
+    return issued_ / std::max(swarm_size_, MIN_SWARM);
+}
+
+int OptimizerPSO::getEvaluationBudget() const
+{
+    return budget_;
+}
+
+int OptimizerPSO::getPopulationSize() const
+{
+    return initialized_ ? swarm_size_ : std::max(individuals_, MIN_SWARM);
+}
+
+void OptimizerPSO::addParameters(Parameterizable& params)
+{
+    AbstractOptimizer::addParameters(params);
+
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("evaluations", 1, 100000, 1000, 1), [this](param::Parameter* p) {
+        budget_ = p->as<int>();
+        progress_evaluation_->setProgress(evaluation_, budget_);
+        updateGenerationProgress();
+    });
+
+    param::Parameter::Ptr pg = param::ParameterFactory::declareOutputProgress("generation");
+    progress_generation_ = dynamic_cast<param::OutputProgressParameter*>(pg.get());
+    params.addTemporaryParameter(pg);
+
+    std::map<std::string, int> topologies {
+        {"linear", (int) Topology::Linear},
+        {"grid", (int) Topology::Grid},
+        {"star", (int) Topology::Star},
+        {"random", (int) Topology::Random}
+    };
+    params.addTemporaryParameter(param::ParameterFactory::declareParameterSet("pso/topology", topologies, (int) Topology::Grid),
+                                 topology_);
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("pso/topology_range", 1, 16, 2, 1),
+                                 topology_range_);
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("pso/inertia", 0.0, 1.0, 0.73, 0.01),
+                                 inertia_);
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("pso/phi1", 0.0, 4.0, 2.05, 0.05),
+                                 phi1_);
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("pso/phi2", 0.0, 4.0, 2.05, 0.05),
+                                 phi2_);
+}
+
+void OptimizerPSO::initialize()
+{
+    swarm_size_ = std::max(individuals_, MIN_SWARM);
+
+    std::size_t dim = layout_.size();
+    position_.assign(swarm_size_ * dim, 0.0);
+    velocity_.assign(swarm_size_ * dim, 0.0);
+    best_position_.assign(swarm_size_ * dim, 0.0);
+    best_fitness_.assign(swarm_size_, std::numeric_limits<double>::infinity());
+    values_.assign(swarm_size_ * dim, 0.0);
+
+    pending_.clear();
+    pending_.reserve(swarm_size_);
+
+    initialized_ = true;
+}
+
+bool OptimizerPSO::ask(std::vector<double>& values)
+{
+    if(!initialized_) {
+        initialize();
+    }
+
+    if(issued_ >= budget_ || layout_.empty()) {
+        return false;
+    }
+
+    std::size_t dim = layout_.size();
+    int generation = issued_ / swarm_size_;
+    int particle = issued_ % swarm_size_;
+
+    // every move has its own stream, so the run does not depend on the order of the results
+    rng_.seed(seed_, generation, particle);
+
+    double* x = &position_[particle * dim];
+    if(generation == 0) {
+        rng_.fillUniform(x, dim);
+
+        // initial velocities span half the distance to a random point
+        double* v = &velocity_[particle * dim];
+        rng_.fillUniform(v, dim);
+        for(std::size_t d = 0; d < dim; ++d) {
+            v[d] = 0.5 * (v[d] - x[d]);
+        }
+
+    } else {
+        move(particle);
+    }
+
+    denormalize(x, values);
+    std::copy(values.begin(), values.end(), values_.begin() + particle * dim);
+
+    pending_.push_back(particle);
+    ++issued_;
+
+    if(particle == 0) {
+        updateGenerationProgress();
+    }
+
+    return true;
+}
+
+void OptimizerPSO::updateGenerationProgress()
+{
+    if(progress_generation_) {
+        // counts the swarm iterations that have started, the last one may be cut short by the budget
+        int swarm = std::max(initialized_ ? swarm_size_ : individuals_, MIN_SWARM);
+        progress_generation_->setProgress((issued_ + swarm - 1) / swarm, (budget_ + swarm - 1) / swarm);
+    }
+}
+
+void OptimizerPSO::move(int particle)
+{
+    std::size_t dim = layout_.size();
+
+    double* x = &position_[particle * dim];
+    double* v = &velocity_[particle * dim];
+    const double* p = &best_position_[particle * dim];
+
+    // a particle that was never evaluated has no personal best yet and keeps its direction
+    bool has_best = std::isfinite(best_fitness_[particle]);
+    int neighbor = neighborhoodBest(particle);
+    const double* g = neighbor >= 0 ? &best_position_[neighbor * dim] : nullptr;
+
+    for(std::size_t d = 0; d < dim; ++d) {
+        double cognitive = has_best ? phi1_ * rng_.uniform() * (p[d] - x[d]) : 0.0;
+        double social = g ? phi2_ * rng_.uniform() * (g[d] - x[d]) : 0.0;
+        v[d] = inertia_ * (v[d] + cognitive + social);
+
+        x[d] += v[d];
+        if(x[d] < 0.0) {
+            x[d] = 0.0;
+            v[d] = 0.0;
+        } else if(x[d] > 1.0) {
+            x[d] = 1.0;
+            v[d] = 0.0;
+        }
+    }
+}
+
+int OptimizerPSO::neighborhoodBest(int particle)
+{
+    int best = -1;
+    auto consider = [this, &best](int i) {
+        if(std::isfinite(best_fitness_[i]) && (best < 0 || best_fitness_[i] < best_fitness_[best])) {
+            best = i;
+        }
+    };
+
+    int n = swarm_size_;
+    int k = topology_range_;
+
+    switch(static_cast<Topology>(topology_)) {
+    case Topology::Linear:
+        // a ring of k neighbors on each side
+        for(int o = -k; o <= k; ++o) {
+            consider(((particle + o) % n + n) % n);
+        }
+        break;
+
+    case Topology::Grid: {
+        // a torus, neighbors are at most k steps away
+        int width = std::max(1, (int) std::ceil(std::sqrt((double) n)));
+        int height = (n + width - 1) / width;
+        int px = particle % width;
+        int py = particle / width;
+        for(int dy = -k; dy <= k; ++dy) {
+            for(int dx = std::abs(dy) - k; dx <= k - std::abs(dy); ++dx) {
+                int i = ((py + dy) % height + height) % height * width + ((px + dx) % width + width) % width;
+                if(i < n) {
+                    consider(i);
+                }
+            }
+        }
+        break;
+    }
+
+    case Topology::Random:
+        // k informants drawn anew for every move
+        consider(particle);
+        for(int i = 0; i < k; ++i) {
+            consider(rng_() % n);
+        }
+        break;
+
+    default:
+    case Topology::Star:
+        for(int i = 0; i < n; ++i) {
+            consider(i);
+        }
+        break;
+    }
+
+    return best;
+}
+
+void OptimizerPSO::tell(const std::vector<double>& values, double fitness)
+{
+    std::size_t dim = layout_.size();
+    auto pos = std::find_if(pending_.begin(), pending_.end(), [this, &values, dim](int particle) {
+        return std::equal(values.begin(), values.end(), values_.begin() + particle * dim);
+    });
+    if(pos == pending_.end()) {
+        return;
+    }
+
+    int particle = *pos;
+    pending_.erase(pos);
+
+    if(std::isfinite(fitness) && fitness < best_fitness_[particle]) {
+        best_fitness_[particle] = fitness;
+        std::copy(position_.begin() + particle * dim, position_.begin() + (particle + 1) * dim,
+                  best_position_.begin() + particle * dim);
+    }
+}
+
+void OptimizerPSO::setEvaluationBudget(int budget)
+{
+    budget_ = budget;
+}
+
+void OptimizerPSO::injectIndividual(const std::vector<double>& values, double fitness)
+{
+    if(!initialized_) {
+        initialize();
+    }
+
+    if(!std::isfinite(fitness)) {
+        return;
+    }
+
+    // the migrant becomes the personal best of the worst particle, unknown particles count as the worst
+    int worst = std::max_element(best_fitness_.begin(), best_fitness_.end()) - best_fitness_.begin();
+    if(fitness >= best_fitness_[worst]) {
+        return;
+    }
+
+    normalize(values, &best_position_[worst * layout_.size()]);
+    best_fitness_[worst] = fitness;
+}
+
+void OptimizerPSO::reset()
+{
+    initialized_ = false;
+    issued_ = 0;
+    individual_ = 0;
+
+    AbstractOptimizer::reset();
+    updateGenerationProgress();
+}
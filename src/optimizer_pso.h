@@ -0,0 +1,85 @@
+#ifndef OPTIMIZER_PSO_H
+#define OPTIMIZER_PSO_H
+
+#include "native_optimizer.h"
+#include "philox.h"
+
+namespace csapex
+{
+
+/**
+ * @brief The OptimizerPSO class is a constricted particle swarm optimization.
+ *
+ * Velocities follow v = chi * (v + phi1 * r1 * (personal best - x) + phi2 * r2 * (neighborhood best - x)),
+ * with chi as the "inertia" parameter. A particle moves as soon as it is asked for, using the bests
+ * known at that time, so the swarm never waits for a generation barrier. Positions live in the unit
+ * cube of the parameter layout, a particle that leaves it stops at the bound.
+ */
+class OptimizerPSO : public NativeOptimizer
+{
+    enum class Topology
+    {
+        Linear,
+        Grid,
+        Star,
+        Random
+    };
+
+public:
+    OptimizerPSO();
+
+    std::string getName() const override;
+
+    bool canContinue() const override;
+    int getGeneration() const override;
+    int getEvaluationBudget() const override;
+    int getPopulationSize() const override;
+
+    void addParameters(Parameterizable& params) override;
+
+    bool ask(std::vector<double>& values) override;
+    void tell(const std::vector<double>& values, double fitness) override;
+    void setEvaluationBudget(int budget) override;
+
+    void injectIndividual(const std::vector<double>& values, double fitness) override;
+
+    void reset() override;
+
+private:
+    void initialize();
+
+    void move(int particle);
+    int neighborhoodBest(int particle);
+
+    void updateGenerationProgress();
+
+private:
+    Philox rng_;
+    bool initialized_;
+
+    int budget_;
+    int issued_;
+
+    int topology_;
+    int topology_range_;
+    double inertia_;
+    double phi1_;
+    double phi2_;
+
+    // nullptr inside a portfolio, which owns no parameters
+    param::OutputProgressParameter* progress_generation_;
+
+    int swarm_size_;
+    std::vector<double> position_;
+    std::vector<double> velocity_;
+    std::vector<double> best_position_;
+    std::vector<double> best_fitness_;
+
+    // parameter values of the current positions and the particles waiting for their fitness
+    std::vector<double> values_;
+    std::vector<int> pending_;
+};
+
+}
+
+#endif // OPTIMIZER_PSO_H
@@ -0,0 +1,536 @@
+#include "optimizer_ssde.h"
+
+#include <csapex/param/parameter_factory.h>
+#include <csapex/param/output_progress_parameter.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace csapex;
+
+namespace {
+// DE/rand/1 needs the target and three distinct other individuals
+const int MIN_POPULATION = 4;
+
+// jDE: probability to draw new control parameters for a trial
+const double JDE_TAU = 0.1;
+
+// SHADE: spread around the memory entries and share of the population used as pbest
+const double SHADE_SPREAD = 0.1;
+const double SHADE_P = 0.1;
+
+double standardDeviation(double sum, double sq_sum, int n)
+{
+    if(n < 2) {
+        return 0.0;
+    }
+    double mean = sum / n;
+    return std::sqrt(std::max(0.0, sq_sum / n - mean * mean));
+}
+}
+
+OptimizerSSDE::OptimizerSSDE()
+    : initialized_(false),
+      budget_(1000), issued_(0),
+      f_(0.5), cr_(0.9), adaptation_((int) Adaptation::Fixed), memory_size_(10),
+      population_size_(0), requested_size_(0), generation_(0), generation_start_(0),
+      n_evaluated_(0), next_target_(0),
+      memory_pos_(0),
+      trials_(0), successes_(0), f_sum_(0.0), f_sq_sum_(0.0), cr_sum_(0.0), cr_sq_sum_(0.0)
+{
+
+}
+
+std::string OptimizerSSDE::getName() const
+{
+    return "SSDE";
+}
+
+bool OptimizerSSDE::canContinue() const
+{
+    return issued_ < budget_;
+}
+
+int OptimizerSSDE::getGeneration() const
+{
+    // there are no generation barriers, this counts how often the population could have been replaced
+    return generation_;
+}
+
+int OptimizerSSDE::getEvaluationBudget() const
+{
+    return budget_;
+}
+
+int OptimizerSSDE::getPopulationSize() const
+{
+    return initialized_ ? population_size_ : std::max(individuals_, MIN_POPULATION);
+}
+
+bool OptimizerSSDE::canResizePopulation() const
+{
+    return true;
+}
+
+void OptimizerSSDE::setPopulationSize(int individuals)
+{
+    requested_size_ = std::max(individuals, MIN_POPULATION);
+}
+
+void OptimizerSSDE::getStatistics(YAML::Node& statistics) const
+{
+    static const char* adaptations[] = {"fixed", "jDE", "SHADE"};
+    statistics["adaptation"] = adaptations[adaptation_];
+
+    for(const GenerationStatistics& g : history_) {
+        YAML::Node generation;
+        generation["generation"] = g.generation;
+        generation["trials"] = g.trials;
+        generation["successes"] = g.successes;
+        generation["F/mean"] = g.f_mean;
+        generation["F/std"] = g.f_std;
+        generation["CR/mean"] = g.cr_mean;
+        generation["CR/std"] = g.cr_std;
+        statistics["generations"].push_back(generation);
+    }
+}
+
+void OptimizerSSDE::addParameters(Parameterizable& params)
+{
+    AbstractOptimizer::addParameters(params);
+
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("evaluations", 1, 100000, 1000, 1), [this](param::Parameter* p) {
+        budget_ = p->as<int>();
+        progress_evaluation_->setProgress(evaluation_, budget_);
+    });
+
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("ssde/F", 0.0, 2.0, 0.5, 0.01),
+                                 f_);
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("ssde/CR", 0.0, 1.0, 0.9, 0.01),
+                                 cr_);
+
+    std::map<std::string, int> adaptations {
+        {"fixed", (int) Adaptation::Fixed},
+        {"jDE", (int) Adaptation::JDE},
+        {"SHADE", (int) Adaptation::SHADE}
+    };
+    params.addTemporaryParameter(param::ParameterFactory::declareParameterSet("ssde/adaptation", adaptations,
+                                                                              (int) Adaptation::Fixed),
+                                 adaptation_);
+    params.addTemporaryParameter(param::ParameterFactory::declareRange("ssde/memory_size", 1, 100, 10, 1),
+                                 memory_size_);
+}
+
+void OptimizerSSDE::initialize()
+{
+    population_size_ = std::max(individuals_, MIN_POPULATION);
+
+    std::size_t dim = layout_.size();
+    population_.assign(population_size_ * dim, 0.0);
+    fitness_.assign(population_size_, std::numeric_limits<double>::infinity());
+    evaluated_.assign(population_size_, false);
+    n_evaluated_ = 0;
+    next_target_ = 0;
+    generation_ = 0;
+    generation_start_ = 0;
+    unfilled_.clear();
+
+    population_f_.assign(population_size_, f_);
+    population_cr_.assign(population_size_, cr_);
+
+    memory_f_.assign(memory_size_, 0.5);
+    memory_cr_.assign(memory_size_, 0.5);
+    memory_pos_ = 0;
+    success_f_.clear();
+    success_cr_.clear();
+    success_weight_.clear();
+    reserveSuccesses();
+
+    trials_ = 0;
+    successes_ = 0;
+    f_sum_ = f_sq_sum_ = 0.0;
+    cr_sum_ = cr_sq_sum_ = 0.0;
+    history_.clear();
+    if(budget_ > 0) {
+        history_.reserve(budget_ / population_size_ + 1);
+    }
+
+    for(Pending& p : pending_) {
+        free_.push_back(std::move(p));
+    }
+    pending_.clear();
+
+    initialized_ = true;
+}
+
+void OptimizerSSDE::resizePopulation(int size)
+{
+    std::size_t dim = layout_.size();
+
+    // unknown individuals have infinite fitness, so they are dropped first
+    ranking_.resize(population_size_);
+    for(int i = 0; i < population_size_; ++i) {
+        ranking_[i] = i;
+    }
+    std::stable_sort(ranking_.begin(), ranking_.end(), [this](int a, int b) {
+        return fitness_[a] < fitness_[b];
+    });
+
+    std::vector<double> population(size * dim, 0.0);
+    std::vector<double> fitness(size, std::numeric_limits<double>::infinity());
+    std::vector<bool> evaluated(size, false);
+    std::vector<double> population_f(size, f_);
+    std::vector<double> population_cr(size, cr_);
+
+    int keep = std::min(size, population_size_);
+    for(int i = 0; i < keep; ++i) {
+        int src = ranking_[i];
+        std::copy(population_.begin() + src * dim, population_.begin() + (src + 1) * dim,
+                  population.begin() + i * dim);
+        fitness[i] = fitness_[src];
+        evaluated[i] = evaluated_[src];
+        population_f[i] = population_f_[src];
+        population_cr[i] = population_cr_[src];
+    }
+
+    population_.swap(population);
+    fitness_.swap(fitness);
+    evaluated_.swap(evaluated);
+    population_f_.swap(population_f);
+    population_cr_.swap(population_cr);
+    population_size_ = size;
+    reserveSuccesses();
+
+    // new and still unknown individuals are filled with random candidates
+    n_evaluated_ = 0;
+    unfilled_.clear();
+    for(int i = size - 1; i >= 0; --i) {
+        if(evaluated_[i]) {
+            ++n_evaluated_;
+        } else {
+            unfilled_.push_back(i);
+        }
+    }
+    next_target_ = 0;
+}
+
+bool OptimizerSSDE::ask(std::vector<double>& values)
+{
+    if(!initialized_) {
+        initialize();
+    }
+
+    if(issued_ >= budget_ || layout_.empty()) {
+        return false;
+    }
+
+    Pending p;
+    if(!free_.empty()) {
+        p = std::move(free_.back());
+        free_.pop_back();
+    }
+    p.u.resize(layout_.size());
+
+    if(issued_ - generation_start_ >= population_size_) {
+        ++generation_;
+        generation_start_ = issued_;
+
+        // the targets of pending candidates have to stay valid
+        if(requested_size_ > 0 && requested_size_ != population_size_ && pending_.empty()) {
+            resizePopulation(requested_size_);
+        }
+    }
+
+    // every candidate has its own stream, so the run does not depend on the order of the results
+    rng_.seed(seed_, generation_, issued_ - generation_start_);
+
+    p.trial = false;
+    if(generation_ == 0) {
+        p.target = issued_;
+        sampleRandom(p.u.data());
+
+    } else if(!unfilled_.empty()) {
+        p.target = unfilled_.back();
+        unfilled_.pop_back();
+        sampleRandom(p.u.data());
+
+    } else if(n_evaluated_ < MIN_POPULATION) {
+        // the initial population is still being evaluated, keep exploring until enough of it is known
+        p.target = rng_() % population_size_;
+        sampleRandom(p.u.data());
+
+    } else {
+        p.target = selectTarget();
+        p.trial = true;
+        sampleControl(p.target, p);
+        sampleTrial(p.target, p, p.u.data());
+    }
+
+    denormalize(p.u.data(), p.values);
+    values = p.values;
+
+    pending_.push_back(std::move(p));
+    ++issued_;
+
+    return true;
+}
+
+void OptimizerSSDE::tell(const std::vector<double>& values, double fitness)
+{
+    auto pos = std::find_if(pending_.begin(), pending_.end(), [&values](const Pending& p) {
+        return p.values == values;
+    });
+    if(pos == pending_.end()) {
+        return;
+    }
+
+    double f = std::isfinite(fitness) ? fitness : std::numeric_limits<double>::infinity();
+
+    // replace the target right away, there is no generation to wait for
+    int t = pos->target;
+    if(pos->trial) {
+        double improvement = 0.0;
+        if(evaluated_[t] && f < fitness_[t]) {
+            improvement = std::isfinite(fitness_[t]) ? fitness_[t] - f : 1.0;
+        }
+        recordTrial(*pos, improvement);
+    }
+
+    if(!evaluated_[t] || f <= fitness_[t]) {
+        std::copy(pos->u.begin(), pos->u.end(), population_.begin() + t * pos->u.size());
+        fitness_[t] = f;
+
+        if(pos->trial) {
+            // jDE: successful control parameters survive with the individual
+            population_f_[t] = pos->f;
+            population_cr_[t] = pos->cr;
+        }
+
+        if(!evaluated_[t]) {
+            evaluated_[t] = true;
+            ++n_evaluated_;
+        }
+    }
+
+    free_.push_back(std::move(*pos));
+    pending_.erase(pos);
+}
+
+void OptimizerSSDE::setEvaluationBudget(int budget)
+{
+    budget_ = budget;
+}
+
+void OptimizerSSDE::injectIndividual(const std::vector<double>& values, double fitness)
+{
+    if(!initialized_) {
+        initialize();
+    }
+
+    double f = std::isfinite(fitness) ? fitness : std::numeric_limits<double>::infinity();
+
+    // the migrant replaces the worst individual, unknown individuals count as the worst
+    int worst = std::max_element(fitness_.begin(), fitness_.end()) - fitness_.begin();
+    if(evaluated_[worst] && f >= fitness_[worst]) {
+        return;
+    }
+
+    std::size_t dim = layout_.size();
+    normalize(values, &population_[worst * dim]);
+    fitness_[worst] = f;
+
+    if(!evaluated_[worst]) {
+        evaluated_[worst] = true;
+        ++n_evaluated_;
+    }
+}
+
+int OptimizerSSDE::selectTarget()
+{
+    // round robin over the known individuals gives every one of them the same number of trials
+    do {
+        next_target_ = (next_target_ + 1) % population_size_;
+    } while(!evaluated_[next_target_]);
+
+    return next_target_;
+}
+
+void OptimizerSSDE::sampleRandom(double* u)
+{
+    rng_.fillUniform(u, layout_.size());
+}
+
+void OptimizerSSDE::sampleControl(int target, Pending& p)
+{
+    switch(static_cast<Adaptation>(adaptation_)) {
+    case Adaptation::JDE:
+        p.f = rng_.uniform() < JDE_TAU ? 0.1 + 0.9 * rng_.uniform() : population_f_[target];
+        p.cr = rng_.uniform() < JDE_TAU ? rng_.uniform() : population_cr_[target];
+        break;
+
+    case Adaptation::SHADE: {
+        std::size_t r = rng_() % memory_f_.size();
+        p.cr = std::max(0.0, std::min(1.0, memory_cr_[r] + SHADE_SPREAD * rng_.normal()));
+
+        // F follows a Cauchy distribution, non-positive values are drawn again
+        do {
+            p.f = memory_f_[r] + SHADE_SPREAD * std::tan(M_PI * (rng_.uniform() - 0.5));
+        } while(p.f <= 0.0);
+        p.f = std::min(p.f, 1.0);
+        break;
+    }
+
+    default:
+    case Adaptation::Fixed:
+        p.f = f_;
+        p.cr = cr_;
+        break;
+    }
+}
+
+int OptimizerSSDE::selectPBest()
+{
+    ranking_.clear();
+    for(int i = 0; i < population_size_; ++i) {
+        if(evaluated_[i]) {
+            ranking_.push_back(i);
+        }
+    }
+
+    std::size_t p = std::max<std::size_t>(2, SHADE_P * ranking_.size());
+    std::partial_sort(ranking_.begin(), ranking_.begin() + p, ranking_.end(), [this](int a, int b) {
+        return fitness_[a] < fitness_[b];
+    });
+    return ranking_[rng_() % p];
+}
+
+void OptimizerSSDE::sampleTrial(int target, const Pending& p, double* u)
+{
+    std::size_t dim = layout_.size();
+    bool shade = static_cast<Adaptation>(adaptation_) == Adaptation::SHADE;
+
+    int pbest = shade ? selectPBest() : -1;
+
+    // DE/rand/1 needs three other individuals, current-to-pbest/1 two
+    int n = shade ? 2 : 3;
+    int r[3];
+    for(int i = 0; i < n; ++i) {
+        bool distinct;
+        do {
+            r[i] = rng_() % population_size_;
+            distinct = evaluated_[r[i]] && r[i] != target;
+            for(int j = 0; j < i; ++j) {
+                distinct = distinct && r[i] != r[j];
+            }
+        } while(!distinct);
+    }
+
+    const double* xt = &population_[target * dim];
+    const double* x1 = &population_[r[0] * dim];
+    const double* x2 = &population_[r[1] * dim];
+    const double* x3 = shade ? &population_[pbest * dim] : &population_[r[2] * dim];
+
+    std::size_t jrand = rng_() % dim;
+    for(std::size_t d = 0; d < dim; ++d) {
+        if(d == jrand || rng_.uniform() < p.cr) {
+            double v;
+            if(shade) {
+                v = xt[d] + p.f * (x3[d] - xt[d]) + p.f * (x1[d] - x2[d]);
+            } else {
+                v = x1[d] + p.f * (x2[d] - x3[d]);
+            }
+
+            // bounce back between the target and the violated bound
+            if(v < 0.0) {
+                v = 0.5 * xt[d];
+            } else if(v > 1.0) {
+                v = 0.5 * (xt[d] + 1.0);
+            }
+            u[d] = v;
+
+        } else {
+            u[d] = xt[d];
+        }
+    }
+}
+
+void OptimizerSSDE::reserveSuccesses()
+{
+    // at most every trial of a generation succeeds
+    success_f_.reserve(population_size_);
+    success_cr_.reserve(population_size_);
+    success_weight_.reserve(population_size_);
+}
+
+void OptimizerSSDE::recordTrial(const Pending& p, double improvement)
+{
+    ++trials_;
+    f_sum_ += p.f;
+    f_sq_sum_ += p.f * p.f;
+    cr_sum_ += p.cr;
+    cr_sq_sum_ += p.cr * p.cr;
+
+    if(improvement > 0.0) {
+        ++successes_;
+        success_f_.push_back(p.f);
+        success_cr_.push_back(p.cr);
+        success_weight_.push_back(improvement);
+    }
+
+    if(trials_ >= population_size_) {
+        closeGeneration();
+    }
+}
+
+void OptimizerSSDE::closeGeneration()
+{
+    GenerationStatistics g;
+    g.generation = history_.size();
+    g.trials = trials_;
+    g.successes = successes_;
+    g.f_mean = f_sum_ / trials_;
+    g.f_std = standardDeviation(f_sum_, f_sq_sum_, trials_);
+    g.cr_mean = cr_sum_ / trials_;
+    g.cr_std = standardDeviation(cr_sum_, cr_sq_sum_, trials_);
+    history_.push_back(g);
+
+    if(!success_f_.empty()) {
+        // SHADE: weighted Lehmer mean for F, weighted mean for CR
+        double weight_sum = 0.0;
+        for(double w : success_weight_) {
+            weight_sum += w;
+        }
+
+        double cr = 0.0, f_sq = 0.0, f = 0.0;
+        for(std::size_t i = 0; i < success_f_.size(); ++i) {
+            double w = success_weight_[i] / weight_sum;
+            cr += w * success_cr_[i];
+            f_sq += w * success_f_[i] * success_f_[i];
+            f += w * success_f_[i];
+        }
+
+        memory_cr_[memory_pos_] = cr;
+        memory_f_[memory_pos_] = f_sq / f;
+        memory_pos_ = (memory_pos_ + 1) % memory_f_.size();
+    }
+
+    success_f_.clear();
+    success_cr_.clear();
+    success_weight_.clear();
+
+    trials_ = 0;
+    successes_ = 0;
+    f_sum_ = f_sq_sum_ = 0.0;
+    cr_sum_ = cr_sq_sum_ = 0.0;
+}
+
+void OptimizerSSDE::reset()
+{
+    initialized_ = false;
+    issued_ = 0;
+    requested_size_ = 0;
+    individual_ = 0;
+
+    AbstractOptimizer::reset();
+}
@@ -0,0 +1,142 @@
+#ifndef OPTIMIZER_SSDE_H
+#define OPTIMIZER_SSDE_H
+
+#include "native_optimizer.h"
+#include "philox.h"
+
+namespace csapex
+{
+
+/**
+ * @brief The OptimizerSSDE class is a steady-state differential evolution without generation barriers.
+ *
+ * A new trial vector is created as soon as it is asked for, and every result replaces its target
+ * individual right away if it is at least as good. The bookkeeping allows several pending candidates,
+ * but the node evaluates one candidate at a time, so this does not increase utilization yet.
+ *
+ * F and CR are either fixed, self-adapted per individual (jDE) or sampled around a success
+ * history memory (SHADE, with current-to-pbest/1 mutation). Since there are no generations,
+ * the adaptation statistics are collected for every population size worth of trials.
+ *
+ * A generation ends after a population size worth of candidates was issued. A requested
+ * population size takes effect there: shrinking keeps the best individuals, growing adds
+ * random ones.
+ */
+class OptimizerSSDE : public NativeOptimizer
+{
+    enum class Adaptation
+    {
+        Fixed,
+        JDE,
+        SHADE
+    };
+
+    struct Pending
+    {
+        std::vector<double> values;
+        std::vector<double> u;
+        int target;
+
+        bool trial;
+        double f;
+        double cr;
+    };
+
+    struct GenerationStatistics
+    {
+        int generation;
+        int trials;
+        int successes;
+
+        double f_mean;
+        double f_std;
+        double cr_mean;
+        double cr_std;
+    };
+
+public:
+    OptimizerSSDE();
+
+    std::string getName() const override;
+
+    bool canContinue() const override;
+    int getGeneration() const override;
+    int getEvaluationBudget() const override;
+    int getPopulationSize() const override;
+    bool canResizePopulation() const override;
+    void setPopulationSize(int individuals) override;
+
+    void getStatistics(YAML::Node& statistics) const override;
+    void addParameters(Parameterizable& params) override;
+
+    bool ask(std::vector<double>& values) override;
+    void tell(const std::vector<double>& values, double fitness) override;
+    void setEvaluationBudget(int budget) override;
+
+    void injectIndividual(const std::vector<double>& values, double fitness) override;
+
+    void reset() override;
+
+private:
+    void initialize();
+    void resizePopulation(int size);
+
+    int selectTarget();
+    void sampleRandom(double* u);
+    void sampleControl(int target, Pending& p);
+    void sampleTrial(int target, const Pending& p, double* u);
+    int selectPBest();
+
+    void reserveSuccesses();
+    void recordTrial(const Pending& p, double improvement);
+    void closeGeneration();
+
+private:
+    Philox rng_;
+    bool initialized_;
+
+    int budget_;
+    int issued_;
+
+    double f_;
+    double cr_;
+    int adaptation_;
+    int memory_size_;
+
+    int population_size_;
+    int requested_size_;
+    int generation_;
+    int generation_start_;
+    std::vector<int> unfilled_;
+    std::vector<double> population_;
+    std::vector<double> fitness_;
+    std::vector<bool> evaluated_;
+    int n_evaluated_;
+    int next_target_;
+
+    // jDE: control parameters of every individual
+    std::vector<double> population_f_;
+    std::vector<double> population_cr_;
+
+    // SHADE: success history memory and the successes of the current generation
+    std::vector<double> memory_f_;
+    std::vector<double> memory_cr_;
+    std::size_t memory_pos_;
+    std::vector<double> success_f_;
+    std::vector<double> success_cr_;
+    std::vector<double> success_weight_;
+    std::vector<int> ranking_;
+
+    int trials_;
+    int successes_;
+    double f_sum_, f_sq_sum_;
+    double cr_sum_, cr_sq_sum_;
+    std::vector<GenerationStatistics> history_;
+
+    std::vector<Pending> pending_;
+    std::vector<Pending> free_;
+};
+
+}
+
+#endif // OPTIMIZER_SSDE_H
@@ -0,0 +1,138 @@
+#include "parameter_batch.h"
+
+#include <csapex/param/parameter.h>
+
+using namespace csapex;
+
+ParameterBatch::ParameterBatch()
+{
+
+}
+
+void ParameterBatch::clear()
+{
+    // keeps the capacity, decoding an individual does not allocate after the first one
+    entries_.clear();
+}
+
+ParameterBatch::Entry& ParameterBatch::stage(param::Parameter* p, Type type)
+{
+    entries_.emplace_back();
+    Entry& e = entries_.back();
+    e.param = p;
+    e.type = type;
+    return e;
+}
+
+void ParameterBatch::setDouble(param::Parameter* p, double value)
+{
+    stage(p, Type::Double).d = value;
+}
+
+void ParameterBatch::setInt(param::Parameter* p, int value)
+{
+    stage(p, Type::Int).i = value;
+}
+
+void ParameterBatch::setBool(param::Parameter* p, bool value)
+{
+    stage(p, Type::Bool).b = value;
+}
+
+void ParameterBatch::setInterval(param::Parameter* p, const std::pair<int, int>& value)
+{
+    stage(p, Type::IntInterval).interval = value;
+}
+
+void ParameterBatch::setDoubleInterval(param::Parameter* p, const std::pair<double, double>& value)
+{
+    stage(p, Type::DoubleInterval).double_interval = value;
+}
+
+bool ParameterBatch::staged(const param::Parameter* p, bool high, double& value) const
+{
+    for(const Entry& e : entries_) {
+        if(e.param != p) {
+            continue;
+        }
+
+        switch(e.type) {
+        case Type::Double:
+            value = e.d;
+            break;
+        case Type::Int:
+            value = e.i;
+            break;
+        case Type::Bool:
+            value = e.b ? 1.0 : 0.0;
+            break;
+        case Type::IntInterval:
+            value = high ? e.interval.second : e.interval.first;
+            break;
+        case Type::DoubleInterval:
+            value = high ? e.double_interval.second : e.double_interval.first;
+            break;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool ParameterBatch::write(const Entry& e)
+{
+    switch(e.type) {
+    case Type::Double:
+        if(e.param->as<double>() == e.d) {
+            return false;
+        }
+        e.param->setSilent<double>(e.d);
+        return true;
+
+    case Type::Int:
+        if(e.param->as<int>() == e.i) {
+            return false;
+        }
+        e.param->setSilent<int>(e.i);
+        return true;
+
+    case Type::Bool:
+        if(e.param->as<bool>() == e.b) {
+            return false;
+        }
+        e.param->setSilent<bool>(e.b);
+        return true;
+
+    case Type::IntInterval:
+        if(e.param->as<std::pair<int, int>>() == e.interval) {
+            return false;
+        }
+        e.param->setSilent<std::pair<int, int>>(e.interval);
+        return true;
+
+    case Type::DoubleInterval:
+        if(e.param->as<std::pair<double, double>>() == e.double_interval) {
+            return false;
+        }
+        e.param->setSilent<std::pair<double, double>>(e.double_interval);
+        return true;
+    }
+    return false;
+}
+
+std::size_t ParameterBatch::commit()
+{
+    changed_.clear();
+    for(const Entry& e : entries_) {
+        if(write(e)) {
+            changed_.push_back(e.param);
+        }
+    }
+    entries_.clear();
+
+    // all values are in place before the first callback runs
+    for(param::Parameter* p : changed_) {
+        p->triggerChange();
+    }
+
+    return changed_.size();
+}
@@ -0,0 +1,76 @@
+#ifndef PARAMETER_BATCH_H
+#define PARAMETER_BATCH_H
+
+#include <csapex/param/param_fwd.h>
+
+#include <utility>
+#include <vector>
+
+namespace csapex
+{
+
+/**
+ * @brief The ParameterBatch class applies all values of an individual as one transaction.
+ *
+ * Values are staged first and written in commit(). Parameters that already hold their staged
+ * value are skipped, the others are written silently and only notified once all of them carry
+ * the new values, so change callbacks in the graph never see a half applied individual.
+ */
+class ParameterBatch
+{
+    enum class Type
+    {
+        Double,
+        Int,
+        Bool,
+        IntInterval,
+        DoubleInterval
+    };
+
+    struct Entry
+    {
+        param::Parameter* param;
+        Type type;
+
+        double d;
+        int i;
+        bool b;
+        std::pair<int, int> interval;
+        std::pair<double, double> double_interval;
+    };
+
+public:
+    ParameterBatch();
+
+    void clear();
+
+    void setDouble(param::Parameter* p, double value);
+    void setInt(param::Parameter* p, int value);
+    void setBool(param::Parameter* p, bool value);
+    void setInterval(param::Parameter* p, const std::pair<int, int>& value);
+    void setDoubleInterval(param::Parameter* p, const std::pair<double, double>& value);
+
+    /**
+     * @brief staged looks up the value staged for a parameter, interval bounds are selected by high
+     * @return false, if nothing is staged for the parameter
+     */
+    bool staged(const param::Parameter* p, bool high, double& value) const;
+
+    /**
+     * @brief commit writes the staged values and notifies the changed parameters
+     * @return the number of parameters that changed
+     */
+    std::size_t commit();
+
+private:
+    Entry& stage(param::Parameter* p, Type type);
+    bool write(const Entry& e);
+
+private:
+    std::vector<Entry> entries_;
+    std::vector<param::Parameter*> changed_;
+};
+
+}
+
+#endif // PARAMETER_BATCH_H
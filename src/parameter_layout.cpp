@@ -0,0 +1,232 @@
+#include "parameter_layout.h"
+
+#include <csapex/param/range_parameter.h>
+#include <csapex/param/interval_parameter.h>
+#include <csapex/param/parameter.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+using namespace csapex;
+
+namespace {
+std::atomic<unsigned long> next_revision(1);
+}
+
+ParameterLayout::ParameterLayout()
+    : revision_(0)
+{
+
+}
+
+void ParameterLayout::build(const std::vector<param::ParameterPtr>& params)
+{
+    params_.clear();
+    slots_.clear();
+    revision_ = next_revision++;
+
+    for(const csapex::param::Parameter::Ptr& p : params) {
+        params_.push_back(p.get());
+
+        // TODO: support more types
+        param::RangeParameter* range = dynamic_cast<param::RangeParameter*>(p.get());
+        if(range) {
+            if(range->is<double>()) {
+                slots_.push_back(Slot {p.get(), Kind::DoubleRange,
+                                       range->min<double>(), range->max<double>(), range->step<double>()});
+                continue;
+
+            } else if(range->is<int>()) {
+                slots_.push_back(Slot {p.get(), Kind::IntRange,
+                                       (double) range->min<int>(), (double) range->max<int>(), (double) range->step<int>()});
+                continue;
+            }
+        }
+
+        param::IntervalParameter* interval = dynamic_cast<param::IntervalParameter*>(p.get());
+        if(interval && interval->is<std::pair<int, int>>()) {
+            double min = interval->min<int>();
+            double max = interval->max<int>();
+            double step = interval->step<int>();
+
+            slots_.push_back(Slot {p.get(), Kind::IntervalLow, min, max, step});
+            slots_.push_back(Slot {p.get(), Kind::IntervalHigh, min, max, step});
+            continue;
+
+        } else if(interval && interval->is<std::pair<double, double>>()) {
+            double min = interval->min<double>();
+            double max = interval->max<double>();
+            double step = interval->step<double>();
+
+            slots_.push_back(Slot {p.get(), Kind::DoubleIntervalLow, min, max, step});
+            slots_.push_back(Slot {p.get(), Kind::DoubleIntervalHigh, min, max, step});
+            continue;
+        }
+    }
+}
+
+bool ParameterLayout::matches(const std::vector<param::ParameterPtr>& params) const
+{
+    if(params.size() != params_.size()) {
+        return false;
+    }
+    for(std::size_t i = 0, n = params.size(); i < n; ++i) {
+        if(params[i].get() != params_[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+unsigned long ParameterLayout::revision() const
+{
+    return revision_;
+}
+
+std::size_t ParameterLayout::size() const
+{
+    return slots_.size();
+}
+
+bool ParameterLayout::empty() const
+{
+    return slots_.empty();
+}
+
+const ParameterLayout::Slot& ParameterLayout::operator [] (std::size_t i) const
+{
+    return slots_[i];
+}
+
+std::string ParameterLayout::name(std::size_t i) const
+{
+    const Slot& slot = slots_[i];
+    switch(slot.kind) {
+    case Kind::IntervalLow:
+    case Kind::DoubleIntervalLow:
+        return slot.param->name() + ".low";
+    case Kind::IntervalHigh:
+    case Kind::DoubleIntervalHigh:
+        return slot.param->name() + ".high";
+    default:
+        return slot.param->name();
+    }
+}
+
+void ParameterLayout::describe(YAML::Node& out) const
+{
+    for(std::size_t i = 0, n = slots_.size(); i < n; ++i) {
+        const Slot& slot = slots_[i];
+        YAML::Node param_node;
+        param_node["name"] = name(i);
+        param_node["type"] = "double/range";
+        param_node["min"] = slot.min;
+        param_node["max"] = slot.max;
+        param_node["step"] = slot.step;
+
+        out["params"].push_back(param_node);
+    }
+}
+
+double ParameterLayout::value(std::size_t i) const
+{
+    const Slot& slot = slots_[i];
+    switch(slot.kind) {
+    case Kind::DoubleRange:
+        return slot.param->as<double>();
+    case Kind::IntRange:
+        return slot.param->as<int>();
+    case Kind::IntervalLow:
+        return slot.param->as<std::pair<int, int>>().first;
+    case Kind::IntervalHigh:
+        return slot.param->as<std::pair<int, int>>().second;
+    case Kind::DoubleIntervalLow:
+        return slot.param->as<std::pair<double, double>>().first;
+    case Kind::DoubleIntervalHigh:
+        return slot.param->as<std::pair<double, double>>().second;
+    }
+    return 0.0;
+}
+
+void ParameterLayout::read(std::vector<double>& out) const
+{
+    out.resize(slots_.size());
+
+    for(std::size_t i = 0, n = slots_.size(); i < n; ++i) {
+        out[i] = value(i);
+    }
+}
+
+void ParameterLayout::read(const ParameterBatch& staged, std::vector<double>& out) const
+{
+    out.resize(slots_.size());
+
+    for(std::size_t i = 0, n = slots_.size(); i < n; ++i) {
+        const Slot& slot = slots_[i];
+        bool high = slot.kind == Kind::IntervalHigh || slot.kind == Kind::DoubleIntervalHigh;
+        if(!staged.staged(slot.param, high, out[i])) {
+            out[i] = value(i);
+        }
+    }
+}
+
+void ParameterLayout::repair(double* values) const
+{
+    for(std::size_t i = 0, n = slots_.size(); i < n; ++i) {
+        const Slot& slot = slots_[i];
+        double& v = values[i];
+        v = std::max(slot.min, std::min(slot.max, v));
+
+        switch(slot.kind) {
+        case Kind::IntRange:
+        case Kind::IntervalLow:
+        case Kind::IntervalHigh:
+            v = std::round(v);
+            break;
+        default:
+            break;
+        }
+
+        // the high slot always directly follows its low slot
+        if(slot.kind == Kind::IntervalHigh || slot.kind == Kind::DoubleIntervalHigh) {
+            if(values[i - 1] > v) {
+                std::swap(values[i - 1], v);
+            }
+        }
+    }
+}
+
+std::size_t ParameterLayout::apply(const double* values) const
+{
+    batch_.clear();
+
+    for(std::size_t i = 0, n = slots_.size(); i < n; ++i) {
+        const Slot& slot = slots_[i];
+        switch(slot.kind) {
+        case Kind::DoubleRange:
+            batch_.setDouble(slot.param, values[i]);
+            break;
+        case Kind::IntRange:
+            batch_.setInt(slot.param, values[i]);
+            break;
+        case Kind::IntervalLow:
+            // encodings treat both bounds independently, an interval is always applied in order
+            batch_.setInterval(slot.param, std::pair<int, int>(std::min(values[i], values[i+1]),
+                                                               std::max(values[i], values[i+1])));
+            ++i;
+            break;
+        case Kind::DoubleIntervalLow:
+            batch_.setDoubleInterval(slot.param, std::pair<double, double>(std::min(values[i], values[i+1]),
+                                                                           std::max(values[i], values[i+1])));
+            ++i;
+            break;
+        case Kind::IntervalHigh:
+        case Kind::DoubleIntervalHigh:
+            // always consumed together with the preceding low slot
+            break;
+        }
+    }
+
+    return batch_.commit();
+}
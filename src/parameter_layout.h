@@ -0,0 +1,99 @@
+#ifndef PARAMETER_LAYOUT_H
+#define PARAMETER_LAYOUT_H
+
+#include "parameter_batch.h"
+
+#include <csapex/param/param_fwd.h>
+#include <yaml-cpp/yaml.h>
+
+#include <vector>
+
+namespace csapex
+{
+
+/**
+ * @brief The ParameterLayout class maps a list of parameters to a flat vector of doubles.
+ *
+ * The layout is computed once per run, so that decoding an individual only has to
+ * walk over a prepared list of slots instead of inspecting the parameter types again.
+ */
+class ParameterLayout
+{
+public:
+    enum class Kind
+    {
+        DoubleRange,
+        IntRange,
+        IntervalLow,
+        IntervalHigh,
+        DoubleIntervalLow,
+        DoubleIntervalHigh
+    };
+
+    struct Slot
+    {
+        param::Parameter* param;
+        Kind kind;
+
+        double min;
+        double max;
+        double step;
+    };
+
+public:
+    ParameterLayout();
+
+    void build(const std::vector<param::ParameterPtr>& params);
+    bool matches(const std::vector<param::ParameterPtr>& params) const;
+
+    /**
+     * @brief revision is unique for every build, so that data derived from a layout can be cached
+     */
+    unsigned long revision() const;
+
+    std::size_t size() const;
+    bool empty() const;
+
+    const Slot& operator [] (std::size_t i) const;
+
+    /**
+     * @brief name is the parameter name of a slot, interval bounds get the suffix ".low" or ".high"
+     */
+    std::string name(std::size_t i) const;
+
+    void describe(YAML::Node& out) const;
+
+    /**
+     * @brief value is the current value of a slot
+     */
+    double value(std::size_t i) const;
+
+    void read(std::vector<double>& out) const;
+
+    /**
+     * @brief read takes the values staged in the batch, and the current value of all other parameters
+     */
+    void read(const ParameterBatch& staged, std::vector<double>& out) const;
+
+    /**
+     * @brief repair clips the values to their bounds, rounds integers and orders interval bounds
+     */
+    void repair(double* values) const;
+
+    /**
+     * @brief apply sets all parameters of an individual in one transaction
+     * @return the number of parameters that changed
+     */
+    std::size_t apply(const double* values) const;
+
+private:
+    std::vector<param::Parameter*> params_;
+    std::vector<Slot> slots_;
+    unsigned long revision_;
+
+    mutable ParameterBatch batch_;
+};
+
+}
+
+#endif // PARAMETER_LAYOUT_H
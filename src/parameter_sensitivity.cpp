@@ -0,0 +1,193 @@
+#include "parameter_sensitivity.h"
+
+#include <csapex/param/parameter.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+using namespace csapex;
+
+ParameterSensitivity::ParameterSensitivity()
+{
+
+}
+
+void ParameterSensitivity::setParameters(const std::vector<param::ParameterPtr>& params)
+{
+    if(layout_.matches(params)) {
+        return;
+    }
+
+    layout_.build(params);
+
+    entries_.clear();
+    slot_entry_.clear();
+    for(std::size_t i = 0, n = layout_.size(); i < n; ++i) {
+        param::Parameter* p = layout_[i].param;
+        if(entries_.empty() || entries_.back().param != p) {
+            entries_.push_back(Entry {p, 0.0, false});
+        }
+        slot_entry_.push_back(entries_.size() - 1);
+    }
+
+    clear();
+}
+
+void ParameterSensitivity::clear()
+{
+    values_.clear();
+    fitness_.clear();
+}
+
+void ParameterSensitivity::reserve(std::size_t samples)
+{
+    values_.reserve(samples * layout_.size());
+    fitness_.reserve(samples);
+}
+
+void ParameterSensitivity::addSample(double fitness)
+{
+    if(!std::isfinite(fitness)) {
+        return;
+    }
+
+    layout_.read(scratch_);
+    values_.insert(values_.end(), scratch_.begin(), scratch_.end());
+    fitness_.push_back(fitness);
+}
+
+std::size_t ParameterSensitivity::samples() const
+{
+    return fitness_.size();
+}
+
+void ParameterSensitivity::analyze(int bins)
+{
+    // frozen parameters keep the score they were frozen with, their later samples are all the same value
+    for(Entry& e : entries_) {
+        if(!e.frozen) {
+            e.importance = 0.0;
+        }
+    }
+
+    std::size_t n = fitness_.size();
+    std::size_t dim = layout_.size();
+    if(n < 2 || dim == 0 || bins < 2) {
+        return;
+    }
+
+    double mean = 0.0;
+    for(double f : fitness_) {
+        mean += f;
+    }
+    mean /= n;
+
+    double total_variance = 0.0;
+    for(double f : fitness_) {
+        total_variance += (f - mean) * (f - mean);
+    }
+    total_variance /= n;
+
+    if(total_variance <= 0.0) {
+        return;
+    }
+
+    bin_sum_.resize(bins);
+    bin_count_.resize(bins);
+
+    for(std::size_t d = 0; d < dim; ++d) {
+        const ParameterLayout::Slot& slot = layout_[d];
+        double range = slot.max - slot.min;
+        if(range <= 0.0 || entries_[slot_entry_[d]].frozen) {
+            continue;
+        }
+
+        std::fill(bin_sum_.begin(), bin_sum_.end(), 0.0);
+        std::fill(bin_count_.begin(), bin_count_.end(), 0);
+
+        for(std::size_t s = 0; s < n; ++s) {
+            double x = (values_[s * dim + d] - slot.min) / range;
+            int b = std::min(bins - 1, std::max(0, (int) (x * bins)));
+            bin_sum_[b] += fitness_[s];
+            ++bin_count_[b];
+        }
+
+        // variance of the conditional expectation E[f | x_d]
+        double main_effect = 0.0;
+        int bins_used = 0;
+        for(int b = 0; b < bins; ++b) {
+            if(bin_count_[b] > 0) {
+                double bin_mean = bin_sum_[b] / bin_count_[b];
+                main_effect += bin_count_[b] * (bin_mean - mean) * (bin_mean - mean);
+                ++bins_used;
+            }
+        }
+        main_effect /= n;
+
+        // bin means scatter by chance alone, for a parameter without influence the ratio is (bins_used - 1) / (n - 1) on average
+        double ratio = main_effect / total_variance - (bins_used - 1) / (double) (n - 1);
+
+        Entry& e = entries_[slot_entry_[d]];
+        e.importance = std::min(1.0, e.importance + std::max(0.0, ratio));
+    }
+}
+
+const std::vector<ParameterSensitivity::Entry>& ParameterSensitivity::entries() const
+{
+    return entries_;
+}
+
+bool ParameterSensitivity::isFrozen(const param::Parameter* p) const
+{
+    for(const Entry& e : entries_) {
+        if(e.param == p) {
+            return e.frozen;
+        }
+    }
+    return false;
+}
+
+std::size_t ParameterSensitivity::freeze(double threshold)
+{
+    // never freeze the most important parameter, something has to remain to be optimized
+    auto most_important = entries_.end();
+    for(auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if(!it->frozen && (most_important == entries_.end() || it->importance > most_important->importance)) {
+            most_important = it;
+        }
+    }
+
+    std::size_t frozen = 0;
+    for(auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if(!it->frozen && it != most_important && it->importance < threshold) {
+            it->frozen = true;
+            ++frozen;
+        }
+    }
+    return frozen;
+}
+
+void ParameterSensitivity::unfreeze()
+{
+    for(Entry& e : entries_) {
+        e.frozen = false;
+    }
+}
+
+void ParameterSensitivity::exportCsv(const std::string& path, std::uint64_t seed) const
+{
+    std::ofstream out(path);
+    if(!out) {
+        throw std::runtime_error(std::string("cannot write sensitivity analysis to ") + path);
+    }
+
+    if(seed != 0) {
+        out << "# seed: " << seed << "\n";
+    }
+    out << "parameter,importance,frozen\n";
+    for(const Entry& e : entries_) {
+        out << e.param->name() << ',' << e.importance << ',' << (e.frozen ? 1 : 0) << '\n';
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef PARAMETER_SENSITIVITY_H
+#define PARAMETER_SENSITIVITY_H
+
+#include "parameter_layout.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace csapex
+{
+
+/**
+ * @brief The ParameterSensitivity class estimates how strongly each parameter influences the fitness.
+ *
+ * The estimate is the first order (main effect) term of a functional ANOVA decomposition,
+ * computed from the evaluations collected so far: the value range of every parameter is split
+ * into bins, and the variance of the mean fitness per bin is related to the total variance.
+ * The share that bins explain by chance is subtracted, so that a parameter without influence
+ * scores about 0 regardless of the number of bins and samples.
+ */
+class ParameterSensitivity
+{
+public:
+    struct Entry
+    {
+        param::Parameter* param;
+        double importance;
+        bool frozen;
+    };
+
+public:
+    ParameterSensitivity();
+
+    void setParameters(const std::vector<param::ParameterPtr>& params);
+    void clear();
+    void reserve(std::size_t samples);
+
+    void addSample(double fitness);
+    std::size_t samples() const;
+
+    void analyze(int bins);
+
+    const std::vector<Entry>& entries() const;
+    bool isFrozen(const param::Parameter* p) const;
+
+    std::size_t freeze(double threshold);
+    void unfreeze();
+
+    /**
+     * @param seed replays the run, 0 if the method cannot be replayed
+     */
+    void exportCsv(const std::string& path, std::uint64_t seed) const;
+
+private:
+    ParameterLayout layout_;
+
+    std::vector<double> scratch_;
+    std::vector<double> values_;
+    std::vector<double> fitness_;
+
+    std::vector<Entry> entries_;
+    std::vector<std::size_t> slot_entry_;
+
+    std::vector<double> bin_sum_;
+    std::vector<std::size_t> bin_count_;
+};
+
+}
+
+#endif // PARAMETER_SENSITIVITY_H
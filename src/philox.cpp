@@ -0,0 +1,155 @@
+#include "philox.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace csapex;
+
+namespace {
+const std::uint32_t M0 = 0xD2511F53;
+const std::uint32_t M1 = 0xCD9E8D57;
+const std::uint32_t W0 = 0x9E3779B9;
+const std::uint32_t W1 = 0xBB67AE85;
+
+const int ROUNDS = 10;
+
+// counter blocks generated together, enough for AVX2 and AVX-512 lanes
+const std::size_t LANES = 16;
+
+// maps 32 random bits to the open interval (0, 1), which keeps log() in Box-Muller finite
+inline double toUnit(std::uint32_t bits)
+{
+    return (bits + 0.5) * (1.0 / 4294967296.0);
+}
+}
+
+Philox::Philox(std::uint64_t seed, std::uint32_t generation, std::uint32_t individual)
+{
+    this->seed(seed, generation, individual);
+}
+
+void Philox::seed(std::uint64_t seed, std::uint32_t generation, std::uint32_t individual)
+{
+    key_[0] = (std::uint32_t) seed;
+    key_[1] = (std::uint32_t) (seed >> 32);
+    generation_ = generation;
+    individual_ = individual;
+    block_ = 0;
+    buffer_pos_ = 4;
+}
+
+void Philox::generate(std::uint32_t* out, std::size_t blocks)
+{
+    std::uint32_t c0[LANES], c1[LANES], c2[LANES], c3[LANES];
+
+    for(std::size_t first = 0; first < blocks; first += LANES) {
+        std::size_t lanes = std::min(LANES, blocks - first);
+
+        // the counter is (block index, generation, individual)
+        for(std::size_t l = 0; l < LANES; ++l) {
+            std::uint64_t block = block_ + first + l;
+            c0[l] = (std::uint32_t) block;
+            c1[l] = (std::uint32_t) (block >> 32);
+            c2[l] = generation_;
+            c3[l] = individual_;
+        }
+
+        std::uint32_t k0 = key_[0];
+        std::uint32_t k1 = key_[1];
+        for(int r = 0; r < ROUNDS; ++r) {
+            for(std::size_t l = 0; l < LANES; ++l) {
+                std::uint64_t p0 = (std::uint64_t) M0 * c0[l];
+                std::uint64_t p1 = (std::uint64_t) M1 * c2[l];
+
+                std::uint32_t n0 = (std::uint32_t) (p1 >> 32) ^ c1[l] ^ k0;
+                std::uint32_t n1 = (std::uint32_t) p1;
+                std::uint32_t n2 = (std::uint32_t) (p0 >> 32) ^ c3[l] ^ k1;
+                std::uint32_t n3 = (std::uint32_t) p0;
+
+                c0[l] = n0;
+                c1[l] = n1;
+                c2[l] = n2;
+                c3[l] = n3;
+            }
+            k0 += W0;
+            k1 += W1;
+        }
+
+        for(std::size_t l = 0; l < lanes; ++l) {
+            std::uint32_t* o = out + 4 * (first + l);
+            o[0] = c0[l];
+            o[1] = c1[l];
+            o[2] = c2[l];
+            o[3] = c3[l];
+        }
+    }
+
+    block_ += blocks;
+}
+
+Philox::result_type Philox::operator () ()
+{
+    if(buffer_pos_ >= 4) {
+        generate(buffer_, 1);
+        buffer_pos_ = 0;
+    }
+    return buffer_[buffer_pos_++];
+}
+
+double Philox::uniform()
+{
+    return toUnit((*this)());
+}
+
+double Philox::normal()
+{
+    double u1 = uniform();
+    double u2 = uniform();
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+}
+
+void Philox::fill(std::uint32_t* out, std::size_t n)
+{
+    // batches always start on a fresh block, so they do not depend on single draws before them
+    buffer_pos_ = 4;
+
+    std::size_t blocks = n / 4;
+    generate(out, blocks);
+
+    std::size_t rest = n - 4 * blocks;
+    if(rest > 0) {
+        generate(buffer_, 1);
+        std::copy(buffer_, buffer_ + rest, out + 4 * blocks);
+        buffer_pos_ = 4;
+    }
+}
+
+void Philox::fillUniform(double* out, std::size_t n)
+{
+    std::uint32_t bits[4 * LANES];
+
+    for(std::size_t first = 0; first < n; first += 4 * LANES) {
+        std::size_t count = std::min(4 * LANES, n - first);
+        fill(bits, count);
+
+        for(std::size_t i = 0; i < count; ++i) {
+            out[first + i] = toUnit(bits[i]);
+        }
+    }
+}
+
+void Philox::fillNormal(double* out, std::size_t n)
+{
+    fillUniform(out, n);
+
+    for(std::size_t i = 0; i + 1 < n; i += 2) {
+        double r = std::sqrt(-2.0 * std::log(out[i]));
+        double phi = 2.0 * M_PI * out[i + 1];
+        out[i] = r * std::cos(phi);
+        out[i + 1] = r * std::sin(phi);
+    }
+
+    if(n % 2 == 1) {
+        out[n - 1] = std::sqrt(-2.0 * std::log(out[n - 1])) * std::cos(2.0 * M_PI * uniform());
+    }
+}
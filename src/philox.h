@@ -0,0 +1,56 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace csapex
+{
+
+/**
+ * @brief The Philox class is the counter-based Philox4x32-10 random number generator.
+ *
+ * A stream is keyed by the run seed, the generation and the individual, so every offspring can
+ * draw its own numbers independently of the order in which offspring are generated, and a run can
+ * be replayed exactly from its seed. The batch functions generate several counter blocks per call
+ * lane by lane, which lets the compiler vectorize the rounds.
+ * The class satisfies the UniformRandomBitGenerator requirements and works with <random>.
+ */
+class Philox
+{
+public:
+    typedef std::uint32_t result_type;
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+
+public:
+    Philox(std::uint64_t seed = 0, std::uint32_t generation = 0, std::uint32_t individual = 0);
+
+    void seed(std::uint64_t seed, std::uint32_t generation, std::uint32_t individual);
+
+    result_type operator () ();
+
+    double uniform();
+    double normal();
+
+    void fill(std::uint32_t* out, std::size_t n);
+    void fillUniform(double* out, std::size_t n);
+    void fillNormal(double* out, std::size_t n);
+
+private:
+    void generate(std::uint32_t* out, std::size_t blocks);
+
+private:
+    std::uint32_t key_[2];
+    std::uint32_t generation_;
+    std::uint32_t individual_;
+    std::uint64_t block_;
+
+    std::uint32_t buffer_[4];
+    int buffer_pos_;
+};
+
+}
+
+#endif // PHILOX_H
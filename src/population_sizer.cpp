@@ -0,0 +1,160 @@
+#include "population_sizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace csapex;
+
+namespace {
+// DE needs the target and three distinct other individuals
+const int MIN_POPULATION = 4;
+}
+
+PopulationSizer::PopulationSizer()
+    : adaptive_(false), min_size_(10), max_size_(100),
+      initial_diversity_(-1.0), initial_spread_(-1.0)
+{
+
+}
+
+void PopulationSizer::configure(bool adaptive, int min_size, int max_size)
+{
+    adaptive_ = adaptive;
+    min_size_ = std::max(MIN_POPULATION, std::min(min_size, max_size));
+    max_size_ = std::max(min_size_, max_size);
+}
+
+void PopulationSizer::setParameters(const std::vector<param::ParameterPtr>& params)
+{
+    if(!layout_.matches(params)) {
+        layout_.build(params);
+    }
+}
+
+void PopulationSizer::reset()
+{
+    samples_.clear();
+    fitness_.clear();
+    history_.clear();
+
+    initial_diversity_ = -1.0;
+    initial_spread_ = -1.0;
+}
+
+bool PopulationSizer::isAdaptive() const
+{
+    return adaptive_;
+}
+
+void PopulationSizer::addSample(double fitness)
+{
+    layout_.read(values_);
+
+    for(std::size_t d = 0, n = layout_.size(); d < n; ++d) {
+        const ParameterLayout::Slot& slot = layout_[d];
+        double range = slot.max - slot.min;
+        samples_.push_back(range > 0.0 ? (values_[d] - slot.min) / range : 0.0);
+    }
+
+    fitness_.push_back(fitness);
+}
+
+double PopulationSizer::diversity()
+{
+    std::size_t dim = layout_.size();
+    std::size_t n = fitness_.size();
+    if(dim == 0 || n < 2) {
+        return 0.0;
+    }
+
+    centroid_.assign(dim, 0.0);
+    for(std::size_t i = 0; i < n; ++i) {
+        const double* x = &samples_[i * dim];
+        for(std::size_t d = 0; d < dim; ++d) {
+            centroid_[d] += x[d];
+        }
+    }
+    for(double& c : centroid_) {
+        c /= n;
+    }
+
+    // the mean squared pairwise distance is twice the mean squared distance to the centroid
+    double sq_sum = 0.0;
+    for(std::size_t i = 0; i < n; ++i) {
+        const double* x = &samples_[i * dim];
+        for(std::size_t d = 0; d < dim; ++d) {
+            double delta = x[d] - centroid_[d];
+            sq_sum += delta * delta;
+        }
+    }
+    return std::sqrt(sq_sum / (n * dim));
+}
+
+double PopulationSizer::fitnessSpread()
+{
+    // sorting in place is fine, the samples are dropped after this generation
+    auto end = std::remove_if(fitness_.begin(), fitness_.end(), [](double f) {
+        return !std::isfinite(f);
+    });
+    std::size_t n = end - fitness_.begin();
+    if(n < 2) {
+        return 0.0;
+    }
+
+    std::sort(fitness_.begin(), end);
+    return fitness_[(3 * (n - 1)) / 4] - fitness_[(n - 1) / 4];
+}
+
+const PopulationSizer::Generation& PopulationSizer::closeGeneration(int generation, int size)
+{
+    Generation g;
+    g.generation = generation;
+    g.evaluations = fitness_.size();
+    g.size = size;
+    g.diversity = diversity();
+    g.fitness_spread = fitnessSpread();
+    g.next_size = size;
+
+    if(g.evaluations >= 2) {
+        if(initial_diversity_ < 0.0) {
+            initial_diversity_ = g.diversity;
+            initial_spread_ = g.fitness_spread;
+        }
+
+        double diversity_ratio = initial_diversity_ > 0.0 ? g.diversity / initial_diversity_ : 0.0;
+        double spread_ratio = initial_spread_ > 0.0 ? g.fitness_spread / initial_spread_ : 0.0;
+        double activity = std::min(1.0, std::max(diversity_ratio, spread_ratio));
+
+        if(adaptive_) {
+            double target = min_size_ + activity * (max_size_ - min_size_);
+            target = std::max(0.5 * size, std::min(2.0 * size, target));
+            g.next_size = std::max(min_size_, std::min(max_size_, (int) std::round(target)));
+        }
+    }
+
+    history_.push_back(g);
+
+    samples_.clear();
+    fitness_.clear();
+
+    return history_.back();
+}
+
+const std::vector<PopulationSizer::Generation>& PopulationSizer::history() const
+{
+    return history_;
+}
+
+void PopulationSizer::getStatistics(YAML::Node& statistics) const
+{
+    for(const Generation& g : history_) {
+        YAML::Node generation;
+        generation["generation"] = g.generation;
+        generation["evaluations"] = g.evaluations;
+        generation["size"] = g.size;
+        generation["next_size"] = g.next_size;
+        generation["diversity"] = g.diversity;
+        generation["fitness_spread"] = g.fitness_spread;
+        statistics["population"].push_back(generation);
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef POPULATION_SIZER_H
+#define POPULATION_SIZER_H
+
+#include "parameter_layout.h"
+
+#include <vector>
+
+namespace csapex
+{
+
+/**
+ * @brief The PopulationSizer class measures the diversity of every generation and derives the next population size.
+ *
+ * Genotype diversity is the root mean square distance of the individuals to their centroid in
+ * normalized coordinates, which is proportional to the mean pairwise distance. Fitness spread is
+ * the interquartile range, so a few penalty values do not dominate it. Both are compared to the
+ * first generation: while either of them stays high the population grows towards the maximum,
+ * a converged population shrinks towards the minimum. The size at most halves or doubles per
+ * generation.
+ */
+class PopulationSizer
+{
+public:
+    struct Generation
+    {
+        int generation;
+        int evaluations;
+        int size;
+        int next_size;
+
+        double diversity;
+        double fitness_spread;
+    };
+
+public:
+    PopulationSizer();
+
+    void configure(bool adaptive, int min_size, int max_size);
+    void setParameters(const std::vector<param::ParameterPtr>& params);
+    void reset();
+
+    bool isAdaptive() const;
+
+    /**
+     * @brief addSample records the current parameter values and their fitness
+     */
+    void addSample(double fitness);
+
+    /**
+     * @brief closeGeneration computes the metrics of the recorded samples and clears them
+     * @return the metrics, next_size is the population size for the next generation
+     */
+    const Generation& closeGeneration(int generation, int size);
+
+    const std::vector<Generation>& history() const;
+    void getStatistics(YAML::Node& statistics) const;
+
+private:
+    double diversity();
+    double fitnessSpread();
+
+private:
+    bool adaptive_;
+    int min_size_;
+    int max_size_;
+
+    ParameterLayout layout_;
+    std::vector<double> values_;
+
+    std::vector<double> samples_;
+    std::vector<double> fitness_;
+    std::vector<double> centroid_;
+
+    double initial_diversity_;
+    double initial_spread_;
+
+    std::vector<Generation> history_;
+};
+
+}
+
+#endif // POPULATION_SIZER_H
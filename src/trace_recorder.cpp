@@ -0,0 +1,250 @@
+#include "trace_recorder.h"
+
+#include <fstream>
+#include <stdexcept>
+
+using namespace csapex;
+
+namespace {
+std::atomic<std::uint64_t> g_epoch(0);
+
+// a thread may record into several recorders, e.g. the node and a local search running in it
+const int CACHE_SLOTS = 4;
+
+struct ThreadCache
+{
+    const void* owner;
+    std::uint64_t epoch;
+    void* buffer;
+};
+
+thread_local ThreadCache t_cache[CACHE_SLOTS] {};
+thread_local int t_cache_next = 0;
+}
+
+TraceRecorder::TraceRecorder()
+    : enabled_(false), epoch_(0), max_events_(0), seed_(0), recorded_(0), stride_(1)
+{
+
+}
+
+TraceRecorder::~TraceRecorder()
+{
+
+}
+
+void TraceRecorder::start(std::size_t max_events, std::uint64_t seed)
+{
+    std::unique_lock<std::mutex> lock(buffers_mutex_);
+
+    // invalidates the buffers cached by the threads
+    epoch_ = ++g_epoch;
+    buffers_.clear();
+
+    origin_ = Clock::now();
+    max_events_ = max_events;
+    seed_ = seed;
+    recorded_ = 0;
+    stride_ = 1;
+
+    enabled_ = true;
+}
+
+void TraceRecorder::stop()
+{
+    enabled_ = false;
+}
+
+bool TraceRecorder::isEnabled() const
+{
+    return enabled_;
+}
+
+TraceRecorder::Clock::time_point TraceRecorder::now() const
+{
+    return Clock::now();
+}
+
+void TraceRecorder::span(const char* name, Clock::time_point begin, Clock::time_point end, long individual)
+{
+    if(!enabled_ || !accept(individual)) {
+        return;
+    }
+
+    if(begin < origin_) {
+        begin = origin_;
+    }
+
+    Event e;
+    e.name = name;
+    e.phase = 'X';
+    e.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(begin - origin_).count();
+    e.duration = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+    e.individual = individual;
+    record(e);
+}
+
+void TraceRecorder::instant(const char* name, long individual)
+{
+    if(!enabled_) {
+        return;
+    }
+
+    Event e;
+    e.name = name;
+    e.phase = 'i';
+    e.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - origin_).count();
+    e.duration = 0;
+    e.individual = individual;
+    record(e);
+}
+
+bool TraceRecorder::accept(long individual)
+{
+    // the events of this thread have to follow the current stride before the count says anything
+    ThreadBuffer* b = buffer();
+    long stride = stride_;
+    if(b->stride != stride) {
+        compact(b, stride);
+    }
+
+    if(recorded_ >= max_events_ && stride < (1l << 30)) {
+        // thin out: from now on only every second of the previously kept individuals is recorded,
+        // compacting right away keeps the next calls from doubling the stride again
+        stride_.compare_exchange_strong(stride, stride * 2);
+        stride = stride_;
+        compact(b, stride);
+    }
+    return individual < 0 || individual % stride == 0;
+}
+
+void TraceRecorder::record(const Event& e)
+{
+    ThreadBuffer* b = buffer();
+
+    long stride = stride_;
+    if(b->stride != stride) {
+        compact(b, stride);
+    }
+
+    b->events.push_back(e);
+    ++recorded_;
+}
+
+void TraceRecorder::compact(ThreadBuffer* b, long stride)
+{
+    // every thread only ever thins out its own buffer
+    std::size_t kept = 0;
+    for(const Event& e : b->events) {
+        if(e.individual < 0 || e.individual % stride == 0) {
+            b->events[kept++] = e;
+        }
+    }
+    recorded_ -= b->events.size() - kept;
+    b->events.resize(kept);
+    b->stride = stride;
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::buffer()
+{
+    for(const ThreadCache& c : t_cache) {
+        if(c.owner == this && c.epoch == epoch_) {
+            return static_cast<ThreadBuffer*>(c.buffer);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(buffers_mutex_);
+
+    // the entry may have been evicted by another recorder, the buffer of this thread still exists then
+    std::thread::id self = std::this_thread::get_id();
+    ThreadBuffer* b = nullptr;
+    for(const auto& candidate : buffers_) {
+        if(candidate->thread == self) {
+            b = candidate.get();
+            break;
+        }
+    }
+
+    if(!b) {
+        buffers_.emplace_back(new ThreadBuffer);
+        b = buffers_.back().get();
+        b->thread = self;
+        b->tid = buffers_.size();
+        b->stride = stride_;
+        b->events.reserve(1024);
+    }
+
+    ThreadCache& c = t_cache[t_cache_next];
+    t_cache_next = (t_cache_next + 1) % CACHE_SLOTS;
+    c.owner = this;
+    c.epoch = epoch_;
+    c.buffer = b;
+    return b;
+}
+
+void TraceRecorder::write(const std::string& path) const
+{
+    std::unique_lock<std::mutex> lock(buffers_mutex_);
+
+    // spans are dropped with the same stride at the end, so the file respects the limit
+    long stride = 1;
+    while(true) {
+        std::size_t kept = 0;
+        for(const auto& b : buffers_) {
+            for(const Event& e : b->events) {
+                if(e.individual < 0 || e.individual % stride == 0) {
+                    ++kept;
+                }
+            }
+        }
+        if(kept <= max_events_ || stride > (1l << 30)) {
+            break;
+        }
+        stride *= 2;
+    }
+
+    std::ofstream out(path);
+    if(!out) {
+        throw std::runtime_error(std::string("cannot write trace to ") + path);
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",";
+    if(seed_ != 0) {
+        out << "\"otherData\":{\"seed\":\"" << seed_ << "\"},";
+    }
+    out << "\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"csapex_eva\"}}";
+    for(const auto& b : buffers_) {
+        for(const Event& e : b->events) {
+            if(e.individual >= 0 && e.individual % stride != 0) {
+                continue;
+            }
+
+            out << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"optimization\",\"ph\":\"" << e.phase
+                << "\",\"ts\":" << e.timestamp << ",\"pid\":1,\"tid\":" << b->tid;
+            if(e.phase == 'X') {
+                out << ",\"dur\":" << e.duration;
+            } else {
+                out << ",\"s\":\"p\"";
+            }
+            out << ",\"args\":{\"individual\":" << e.individual << "}}";
+        }
+    }
+    out << "\n]}\n";
+}
+
+
+TraceScope::TraceScope(TraceRecorder& recorder, const char* name, long individual)
+    : recorder_(recorder), name_(name), individual_(individual), enabled_(recorder.isEnabled())
+{
+    if(enabled_) {
+        begin_ = recorder_.now();
+    }
+}
+
+TraceScope::~TraceScope()
+{
+    if(enabled_) {
+        recorder_.span(name_, begin_, recorder_.now(), individual_);
+    }
+}
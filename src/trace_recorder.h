@@ -0,0 +1,105 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace csapex
+{
+
+/**
+ * @brief The TraceRecorder class records a timeline of spans in the Chrome trace event format.
+ *
+ * Every thread writes into its own buffer, so recording a span does not take a lock.
+ * Spans are tagged with the individual they belong to. When the number of events exceeds
+ * the limit, only every n-th individual is kept, so the file size stays bounded for very
+ * long runs. Event names have to be string literals.
+ */
+class TraceRecorder
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Event
+    {
+        const char* name;
+        char phase;
+        std::int64_t timestamp;
+        std::int64_t duration;
+        long individual;
+    };
+
+public:
+    TraceRecorder();
+    ~TraceRecorder();
+
+    /**
+     * @param seed replays the run, 0 if the method cannot be replayed
+     */
+    void start(std::size_t max_events, std::uint64_t seed);
+    void stop();
+
+    bool isEnabled() const;
+
+    Clock::time_point now() const;
+
+    void span(const char* name, Clock::time_point begin, Clock::time_point end, long individual);
+    void instant(const char* name, long individual);
+
+    void write(const std::string& path) const;
+
+private:
+    struct ThreadBuffer
+    {
+        std::thread::id thread;
+        int tid;
+        long stride;
+        std::vector<Event> events;
+    };
+
+    ThreadBuffer* buffer();
+    bool accept(long individual);
+    void record(const Event& e);
+    void compact(ThreadBuffer* b, long stride);
+
+private:
+    std::atomic<bool> enabled_;
+    std::uint64_t epoch_;
+
+    Clock::time_point origin_;
+
+    std::size_t max_events_;
+    std::uint64_t seed_;
+    std::atomic<std::size_t> recorded_;
+    std::atomic<long> stride_;
+
+    mutable std::mutex buffers_mutex_;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+};
+
+/**
+ * @brief The TraceScope class records a span for the lifetime of the scope.
+ */
+class TraceScope
+{
+public:
+    TraceScope(TraceRecorder& recorder, const char* name, long individual);
+    ~TraceScope();
+
+private:
+    TraceRecorder& recorder_;
+    const char* name_;
+    long individual_;
+    bool enabled_;
+    TraceRecorder::Clock::time_point begin_;
+};
+
+}
+
+#endif // TRACE_RECORDER_H
@@ -0,0 +1,65 @@
+#include "../src/trace_recorder.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+
+using namespace csapex;
+
+namespace {
+
+struct Trace
+{
+    std::size_t events;
+    std::set<long> individuals;
+};
+
+Trace readTrace(const std::string& path)
+{
+    std::ifstream in(path);
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    Trace trace {0, {}};
+    const std::string key = "\"individual\":";
+    for(std::size_t pos = text.find(key); pos != std::string::npos; pos = text.find(key, pos + 1)) {
+        ++trace.events;
+        trace.individuals.insert(std::stol(text.substr(pos + key.size())));
+    }
+    return trace;
+}
+
+}
+
+TEST(TraceRecorder, LimitKeepsIndividualsSpread)
+{
+    const std::size_t max_events = 1000;
+    const long individuals = 5000;
+
+    TraceRecorder recorder;
+    recorder.start(max_events, 0);
+
+    for(long i = 0; i < individuals; ++i) {
+        for(int span = 0; span < 3; ++span) {
+            TraceRecorder::Clock::time_point now = recorder.now();
+            recorder.span("span", now, now, i);
+        }
+    }
+    recorder.instant("generation", -1);
+
+    std::string path = "trace_recorder_test.json";
+    recorder.write(path);
+    Trace trace = readTrace(path);
+    std::remove(path.c_str());
+
+    EXPECT_LE(trace.events, max_events);
+    EXPECT_GE(trace.events, max_events / 4);
+
+    // thinning out halves the kept individuals per step, it must not collapse to the first one
+    trace.individuals.erase(-1);
+    EXPECT_GE(trace.individuals.size(), max_events / 3 / 4);
+    EXPECT_GE(*trace.individuals.rbegin(), individuals * 3 / 4);
+}